@@ -14,8 +14,25 @@
 
 Command tilt_antenna (Real degrees);
 Command pan_antenna (Real degrees);
+
+// Pan and tilt the antenna at once; finishes when both have settled.
+Command point_antenna (Real pan_degrees, Real tilt_degrees);
+
 Command take_picture();
 
+// Take a panorama spanning the given tilt and pan ranges, with the given
+// overlap of adjacent images, all in degrees.  The lander steps through the
+// images itself; see the Panorama* lookups in plan-interface.h for progress.
+// Images already taken, as given by a PanoramaTilesDone of an earlier attempt,
+// are skipped; "" takes them all.
+Command take_panorama (Real tilt_lo,
+                       Real tilt_hi,
+                       Real pan_lo,
+                       Real pan_hi,
+                       Real vert_overlap,
+                       Real horiz_overlap,
+                       String completed);
+
 Command dig_circular (Real x,
                       Real y,
                       Real depth,
@@ -14,11 +14,32 @@ Command log_info (...);
 Command log_warning (...);
 Command log_error (...);
 
+// Threshold triggers on numeric states, evaluated as telemetry arrives.  A
+// trigger becomes true once "state comparator threshold" has held for
+// persistence seconds, and false once it has failed for as long; each change
+// is published as Trigger(name).  Comparators are <, <=, >, >=, ==, !=.
+// A value that isn't a number (NaN, infinite) satisfies every comparator.
+// Adding a trigger replaces any of the same name.
+Command add_trigger (String name,
+                     String state_name,
+                     String comparator,
+                     Real threshold,
+                     Real persistence);
+Command remove_trigger (String name);
+Boolean Lookup Trigger (String name);
+
 
 // PLEXIL library for lander operations.
 
 LibraryAction Tilt (In Real Degrees);
 LibraryAction Pan  (In Real Degrees);
+LibraryAction PointAntenna (In Real PanDegrees, In Real TiltDegrees);
+LibraryAction Panorama (In Real TiltLo,
+                        In Real TiltHi,
+                        In Real PanLo,
+                        In Real PanHi,
+                        In Real VertOverlap,
+                        In Real HorizOverlap);
 LibraryAction Stow ();
 LibraryAction Unstow ();
 LibraryAction GuardedMove (In Real X,
@@ -61,12 +82,67 @@ Real Lookup BatteryTemperature;
 Boolean Lookup HardTorqueLimitReached (String joint_name);
 Boolean Lookup SoftTorqueLimitReached (String joint_name);
 
+// Statistics of recent telemetry over a trailing window in seconds, e.g.
+// Lookup(EffortMean("ScoopYaw", 5.0)).  Unknown when the window holds no
+// samples.  Windows are limited by the history kept (~history_samples).
+// These are computed on request and never published, so a condition using
+// one is not re-evaluated as telemetry arrives.
+Real Lookup PositionMin (String joint_name, Real window);
+Real Lookup PositionMax (String joint_name, Real window);
+Real Lookup PositionMean (String joint_name, Real window);
+Real Lookup PositionRMS (String joint_name, Real window);
+Real Lookup VelocityMin (String joint_name, Real window);
+Real Lookup VelocityMax (String joint_name, Real window);
+Real Lookup VelocityMean (String joint_name, Real window);
+Real Lookup VelocityRMS (String joint_name, Real window);
+Real Lookup EffortMin (String joint_name, Real window);
+Real Lookup EffortMax (String joint_name, Real window);
+Real Lookup EffortMean (String joint_name, Real window);
+Real Lookup EffortRMS (String joint_name, Real window);
+Real Lookup StateOfChargeMin (Real window);
+Real Lookup StateOfChargeMax (Real window);
+Real Lookup StateOfChargeMean (Real window);
+Real Lookup StateOfChargeRMS (Real window);
+Real Lookup RemainingUsefulLifeMin (Real window);
+Real Lookup RemainingUsefulLifeMax (Real window);
+Real Lookup RemainingUsefulLifeMean (Real window);
+Real Lookup RemainingUsefulLifeRMS (Real window);
+Real Lookup BatteryTemperatureMin (Real window);
+Real Lookup BatteryTemperatureMax (Real window);
+Real Lookup BatteryTemperatureMean (Real window);
+Real Lookup BatteryTemperatureRMS (Real window);
+
 // Faults
 Boolean Lookup SystemFault;
 Boolean Lookup AntennaFault;
 Boolean Lookup ArmFault;
 Boolean Lookup PowerFault;
 
+// Individual faults, by the names given in ../plexil-adapter/OwInterface.h,
+// e.g. Lookup(ArmFaultActive("COLLISION_ERROR")).
+Boolean Lookup SystemFaultActive (String fault_name);
+Boolean Lookup AntennaFaultActive (String fault_name);
+Boolean Lookup ArmFaultActive (String fault_name);
+Boolean Lookup PowerFaultActive (String fault_name);
+
+// Progress of the panorama in progress (or the last one): "Idle", "Slewing",
+// or "Capturing", the number of images taken and in all, and which were taken
+// (one digit per image, row by row: 1 if taken, 0 if not).  Also its
+// estimated duration when started, and actual duration, in seconds.
+String Lookup PanoramaState;
+Real   Lookup PanoramaTilesTaken;
+Real   Lookup PanoramaTiles;
+String Lookup PanoramaTilesDone;
+Real   Lookup PanoramaEstimatedDuration;
+Real   Lookup PanoramaDuration;
+
+// Order in which panoramas take their images: "Serpentine" (row by row,
+// alternating direction), "RowMajor" (row by row), or "MinimumSlew" (least
+// antenna slewing, using its measured rates).  Setting it applies to
+// subsequent panoramas; the default comes from config/panorama.yaml.
+String Lookup PanoramaOrdering;
+Command set_panorama_ordering (String ordering);
+
 // Relevant with GuardedMove only:
 Boolean Lookup GroundFound;
 Real    Lookup GroundPosition;
@@ -79,6 +155,33 @@ Real    Lookup GroundPosition;
 // fine-grained control of concurrency.
 Boolean Lookup Running (String operation_name);
 
+// Query whether the ROS action server for a given operation has connected.
+// Commands for an operation whose server has not connected within a short
+// window after startup fail immediately.
+Boolean Lookup ActionServerReady (String operation_name);
+
+// Timeout of a given operation, in seconds: a command for it still running
+// this long after it started is stopped and fails.  0 means no limit.
+// Defaults come from the autonomy node's configuration (see
+// config/operation_timeouts.yaml); setting a timeout applies to subsequent
+// commands for the operation.
+Real Lookup OperationTimeout (String operation_name);
+Command set_operation_timeout (String operation_name, Real seconds);
+
+// Load on the pool of threads running lander operations: number of operations
+// waiting to start or finish, and number of threads.
+Integer Lookup ActionQueueDepth;
+Integer Lookup ActionThreads;
+
+// Number of value changes and command acks waiting to be delivered to the
+// executive.
+Integer Lookup ExecQueueDepth;
+
+// Number of commands in progress, and the most there have been at once.  The
+// adapter fails commands beyond its capacity (MaxCommands in ow-config.xml).
+Integer Lookup CommandsInProgress;
+Integer Lookup CommandsHighWater;
+
 //////// PLEXIL Utilities
 
 // Predefined, unitless PLEXIL variable for current time.
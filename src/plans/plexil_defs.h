@@ -24,7 +24,8 @@
 
 #define NUM_JOINTS 9
 
-// The following are related to antenna and camera.
+// The following are related to antenna and camera.  Keep the field of view
+// and limits in sync with ../plexil-adapter/panorama_engine.h.
 
 #define LONG_WAIT  5       // seconds
 #define SHORT_WAIT 2       // seconds
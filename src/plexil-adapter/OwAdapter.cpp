@@ -7,7 +7,10 @@
 // OW
 #include "OwAdapter.h"
 #include "OwInterface.h"
+#include "command_slab.h"
 #include "subscriber.h"
+#include "telemetry_filter.h"
+#include "telemetry_trigger.h"
 
 // ROS
 #include <ros/ros.h>
@@ -23,8 +26,12 @@
 #include <StateCacheEntry.hh>
 
 // C++
+#include <cmath>
+#include <atomic>
+#include <functional>
 #include <map>
 #include <mutex>
+#include <unordered_map>
 using std::string;
 using std::vector;
 
@@ -38,139 +45,260 @@ const Value Unknown;
 // An empty argument vector.
 static vector<Value> const EmptyArgs;
 
+// A localized handle on the adapter, which allows a
+// decoupling between the sample system and adapter.
+static OwAdapter* TheAdapter;
+
+// Records of commands in progress, addressed by the ids handed to
+// OwInterface.  See command_slab.h.
+
+struct CommandRecord
+{
+  Command* command = nullptr;
+  AdapterExecInterface* adapter = nullptr;
+};
+
+// Sized in OwAdapter::initialize().
+static std::unique_ptr<CommandSlab<CommandRecord>> Commands;
+static const int DefaultCommandCapacity = 256;
+
 
 //////////////////////// PLEXIL Lookup Support //////////////////////////////
 
-static void stubbed_lookup (const string& name, const string& value)
+static void stubbed_lookup (const string& name, const Value& value)
 {
   // This warning is annoying.  Could parameterize it.
   //  ROS_WARN("PLEXIL Adapter: Stubbed lookup of %s returning %s",
-  //           name.c_str(), value.c_str());
+  //           name.c_str(), value.valueToString().c_str());
 }
 
+// Lookups are dispatched through a table, built once in
+// OwAdapter::initialize(), that maps each state name to a handler computing
+// the state's value from the lookup's arguments.  This makes the cost of a
+// lookup a single hash, independent of the number of states supported.
 
-// NOTE: This macro, and the stub it implements, are temporary.
-#define STATE_STUB(name,val)                    \
-  if (state_name == #name) {                    \
-    stubbed_lookup (#name, #val);               \
-    value_out = val;                            \
-  }
+using LookupHandler = std::function<Value (const vector<Value>& args)>;
 
-static bool lookup (const std::string& state_name,
-                    const std::vector<PLEXIL::Value>& args,
-                    PLEXIL::Value& value_out)
+static std::unordered_map<string, LookupHandler> LookupTable;
+
+static void add_lookup (const string& name, LookupHandler handler)
 {
-  bool retval = true;
+  if (! LookupTable.emplace (name, handler).second) {
+    ROS_WARN ("PLEXIL Adapter: duplicate lookup %s ignored.", name.c_str());
+  }
+}
 
-  // Stubbed mission and system parameters.  Many of these will eventually be
-  // obsolete.
+// NOTE: Stubbed lookups are temporary.
+static void add_stub (const string& name, const Value& val)
+{
+  add_lookup (name, [name, val] (const vector<Value>&) {
+      stubbed_lookup (name, val);
+      return val;
+    });
+}
 
-  STATE_STUB(TrenchLength, 10)
-  else STATE_STUB(TrenchGroundPosition, -0.155)
-  else STATE_STUB(TrenchWidth, 10)
-  else STATE_STUB(TrenchDepth, 2)
-  else STATE_STUB(TrenchPitch, 0)
-  else STATE_STUB(TrenchYaw, 0)
-  else STATE_STUB(TrenchStartX, 5)
-  else STATE_STUB(TrenchStartY, 10)
-  else STATE_STUB(TrenchStartZ, 0)
-  else STATE_STUB(TrenchDumpX, 0)
-  else STATE_STUB(TrenchDumpY, 0)
-  else STATE_STUB(TrenchDumpZ, 5)
-  else STATE_STUB(TrenchIdentified, true)
-  else STATE_STUB(TrenchTargetTimeout, 60)
-  else STATE_STUB(ExcavationTimeout, 10)
-  else STATE_STUB(ExcavationTimeout, 60)
-  else STATE_STUB(SampleGood, true)
-  else STATE_STUB(CollectAndTransferTimeout, 10)
-
-  else if (state_name == "TiltDegrees") {
-    value_out = OwInterface::instance()->getTilt();
-  }
-  else if (state_name == "PanDegrees") {
-    value_out = OwInterface::instance()->getPanDegrees();
-  }
-  else if (state_name == "PanVelocity") {
-    value_out = OwInterface::instance()->getPanVelocity();
-  }
-  else if (state_name == "TiltVelocity") {
-    value_out = OwInterface::instance()->getTiltVelocity();
-  }
-  else if (state_name == "HardTorqueLimitReached") {
-    string s;
-    args[0].getValue(s);
-    value_out = OwInterface::instance()->hardTorqueLimitReached(s);
-  }
-  else if (state_name == "SoftTorqueLimitReached") {
-    string s;
-    args[0].getValue(s);
-    value_out = OwInterface::instance()->softTorqueLimitReached(s);
-  }
-  else if (state_name == "Running") {
-    string operation;
-    args[0].getValue(operation);
-    value_out = OwInterface::instance()->running (operation);
-  }
-  else if (state_name == "StateOfCharge") {
-    value_out = OwInterface::instance()->getStateOfCharge();
-  }
-  else if (state_name == "RemainingUsefulLife") {
-    value_out = OwInterface::instance()->getRemainingUsefulLife();
-  }
-  else if (state_name == "BatteryTemperature") {
-    value_out = OwInterface::instance()->getBatteryTemperature();
-  }
-  else if (state_name == "GroundFound") {
-    value_out = OwInterface::instance()->groundFound();
-  }
-  else if (state_name == "GroundPosition") {
-    value_out = OwInterface::instance()->groundPosition();
-  }
-  // Faults
-  else if (state_name == "SystemFault") {
-    value_out = OwInterface::instance()->systemFault();
-  }
-  else if (state_name == "AntennaFault") {
-    value_out = OwInterface::instance()->antennaFault();
-  }
-  else if (state_name == "ArmFault") {
-    value_out = OwInterface::instance()->armFault();
-  }
-  else if (state_name == "PowerFault") {
-    value_out = OwInterface::instance()->powerFault();
-  }
-  else retval = false;
+// Lookup of an OwInterface query taking no arguments.
+template <typename T>
+static void add_lookup (const string& name, T (OwInterface::*query) () const)
+{
+  add_lookup (name, [query] (const vector<Value>&) {
+      return Value ((OwInterface::instance()->*query)());
+    });
+}
 
-  return retval;
+// Lookup of an OwInterface query taking a single string argument, e.g. a
+// joint or operation name.
+template <typename T>
+static void add_lookup (const string& name,
+                        T (OwInterface::*query) (const string&) const)
+{
+  add_lookup (name, [name, query] (const vector<Value>& args) {
+      string s;
+      if (args.size() != 1 || ! args[0].getValue (s)) {
+        ROS_ERROR ("PLEXIL Adapter: %s requires one string argument.",
+                   name.c_str());
+        return Unknown;
+      }
+      return Value ((OwInterface::instance()->*query)(s));
+    });
 }
 
-//////////////////////////// Command Handling //////////////////////////////
+// Windowed statistics of telemetry history, named <Quantity><Statistic>,
+// e.g. EffortMean("ScoopYaw", 5.0) or StateOfChargeMin(60).  The window is in
+// seconds; the value is unknown when no samples fall within it.
 
-static int CommandId = 0;
+static const std::vector<std::pair<string, Statistic>> Statistics {
+  { "Min", Statistic::Min },
+  { "Max", Statistic::Max },
+  { "Mean", Statistic::Mean },
+  { "RMS", Statistic::RMS }
+};
 
-std::mutex g_shared_mutex;
-using CommandRecord = std::tuple<Command*,
-                                 AdapterExecInterface*,
-                                 bool>;
+static Value statistic_value (double result)
+{
+  return std::isnan (result) ? Unknown : Value (result);
+}
 
-enum CommandRecordFields {CR_COMMAND, CR_ADAPTER, CR_ACK_SENT};
+static void add_statistic_lookups ()
+{
+  static const std::vector<std::pair<string, JointQuantity>> joint_quantities {
+    { "Position", JointQuantity::Position },
+    { "Velocity", JointQuantity::Velocity },
+    { "Effort", JointQuantity::Effort }
+  };
+  static const std::vector<std::pair<string, PowerQuantity>> power_quantities {
+    { "StateOfCharge", PowerQuantity::StateOfCharge },
+    { "RemainingUsefulLife", PowerQuantity::RemainingUsefulLife },
+    { "BatteryTemperature", PowerQuantity::BatteryTemperature }
+  };
+
+  for (const auto& stat : Statistics) {
+    for (const auto& quantity : joint_quantities) {
+      string name = quantity.first + stat.first;
+      JointQuantity q = quantity.second;
+      Statistic st = stat.second;
+      add_lookup (name, [name, q, st] (const vector<Value>& args) {
+          string joint;
+          double window;
+          if (args.size() != 2 || ! args[0].getValue (joint) ||
+              ! args[1].getValue (window)) {
+            ROS_ERROR ("PLEXIL Adapter: %s requires a joint name and "
+                       "a window.", name.c_str());
+            return Unknown;
+          }
+          return statistic_value
+            (OwInterface::instance()->jointStatistic (joint, q, st, window));
+        });
+    }
+    for (const auto& quantity : power_quantities) {
+      string name = quantity.first + stat.first;
+      PowerQuantity q = quantity.second;
+      Statistic st = stat.second;
+      add_lookup (name, [name, q, st] (const vector<Value>& args) {
+          double window;
+          if (args.size() != 1 || ! args[0].getValue (window)) {
+            ROS_ERROR ("PLEXIL Adapter: %s requires a window.", name.c_str());
+            return Unknown;
+          }
+          return statistic_value
+            (OwInterface::instance()->powerStatistic (q, st, window));
+        });
+    }
+  }
+}
 
-static std::map<int, std::unique_ptr<CommandRecord>> CommandRegistry;
+static void initialize_lookups ()
+{
+  // Stubbed mission and system parameters.  Many of these will eventually be
+  // obsolete.
+
+  add_stub ("TrenchLength", 10);
+  add_stub ("TrenchGroundPosition", -0.155);
+  add_stub ("TrenchWidth", 10);
+  add_stub ("TrenchDepth", 2);
+  add_stub ("TrenchPitch", 0);
+  add_stub ("TrenchYaw", 0);
+  add_stub ("TrenchStartX", 5);
+  add_stub ("TrenchStartY", 10);
+  add_stub ("TrenchStartZ", 0);
+  add_stub ("TrenchDumpX", 0);
+  add_stub ("TrenchDumpY", 0);
+  add_stub ("TrenchDumpZ", 5);
+  add_stub ("TrenchIdentified", true);
+  add_stub ("TrenchTargetTimeout", 60);
+  add_stub ("ExcavationTimeout", 10);
+  add_stub ("SampleGood", true);
+  add_stub ("CollectAndTransferTimeout", 10);
+
+  // Antenna
+  add_lookup ("TiltDegrees", &OwInterface::getTilt);
+  add_lookup ("PanDegrees", &OwInterface::getPanDegrees);
+  add_lookup ("PanVelocity", &OwInterface::getPanVelocity);
+  add_lookup ("TiltVelocity", &OwInterface::getTiltVelocity);
+
+  // Panoramas
+  add_lookup ("PanoramaState", &OwInterface::panoramaState);
+  add_lookup ("PanoramaTilesTaken", &OwInterface::panoramaTilesTaken);
+  add_lookup ("PanoramaTiles", &OwInterface::panoramaTiles);
+  add_lookup ("PanoramaTilesDone", &OwInterface::panoramaTilesDone);
+  add_lookup ("PanoramaOrdering", &OwInterface::panoramaOrdering);
+  add_lookup ("PanoramaEstimatedDuration",
+              &OwInterface::panoramaEstimatedDuration);
+  add_lookup ("PanoramaDuration", &OwInterface::panoramaDuration);
+
+  // Joints
+  add_lookup ("HardTorqueLimitReached", &OwInterface::hardTorqueLimitReached);
+  add_lookup ("SoftTorqueLimitReached", &OwInterface::softTorqueLimitReached);
+
+  // Telemetry history
+  add_statistic_lookups();
+
+  // Triggers (see add_trigger below)
+  add_lookup ("Trigger", [] (const vector<Value>& args) {
+      string name;
+      if (args.size() != 1 || ! args[0].getValue (name)) {
+        ROS_ERROR ("PLEXIL Adapter: Trigger requires one string argument.");
+        return Unknown;
+      }
+      return Value (triggerActive (name));
+    });
+
+  // Operations
+  add_lookup ("Running", &OwInterface::running);
+  add_lookup ("ActionQueueDepth", &OwInterface::actionQueueDepth);
+  add_lookup ("ActionThreads", &OwInterface::actionThreadCount);
+  add_lookup ("ActionServerReady", &OwInterface::actionServerReady);
+  add_lookup ("OperationTimeout", &OwInterface::operationTimeout);
+  add_lookup ("ExecQueueDepth", [] (const vector<Value>&) {
+      return Value (TheAdapter->execQueueDepth());
+    });
+  add_lookup ("CommandsInProgress", [] (const vector<Value>&) {
+      return Value (Commands->inUse());
+    });
+  add_lookup ("CommandsHighWater", [] (const vector<Value>&) {
+      return Value (Commands->highWater());
+    });
+
+  // Power
+  add_lookup ("StateOfCharge", &OwInterface::getStateOfCharge);
+  add_lookup ("RemainingUsefulLife", &OwInterface::getRemainingUsefulLife);
+  add_lookup ("BatteryTemperature", &OwInterface::getBatteryTemperature);
+
+  // GuardedMove
+  add_lookup ("GroundFound", &OwInterface::groundFound);
+  add_lookup ("GroundPosition", &OwInterface::groundPosition);
+
+  // Faults
+  add_lookup ("SystemFault", &OwInterface::systemFault);
+  add_lookup ("AntennaFault", &OwInterface::antennaFault);
+  add_lookup ("ArmFault", &OwInterface::armFault);
+  add_lookup ("PowerFault", &OwInterface::powerFault);
+  add_lookup ("SystemFaultActive", &OwInterface::systemFaultActive);
+  add_lookup ("AntennaFaultActive", &OwInterface::antennaFaultActive);
+  add_lookup ("ArmFaultActive", &OwInterface::armFaultActive);
+  add_lookup ("PowerFaultActive", &OwInterface::powerFaultActive);
+}
 
-std::unique_ptr<CommandRecord>& new_command_record(Command* cmd,
-                                                   AdapterExecInterface* intf)
+static bool lookup (const std::string& state_name,
+                    const std::vector<PLEXIL::Value>& args,
+                    PLEXIL::Value& value_out)
 {
-  auto cr = std::make_tuple(cmd, intf, false);
-  CommandRegistry[++CommandId] = std::make_unique<CommandRecord>(cr);
-  return CommandRegistry[CommandId];
+  auto entry = LookupTable.find (state_name);
+  if (entry == LookupTable.end()) return false;
+  value_out = entry->second (args);
+  return true;
 }
 
+//////////////////////////// Command Handling //////////////////////////////
+
+// Acks reach the executive through the adapter's update queue, in order with
+// the value changes published before them, including those held in an open
+// publish batch (see OwAdapter::post).
 static void ack_command (Command* cmd,
                          PLEXIL::CommandHandleValue handle,
                          AdapterExecInterface* intf)
 {
-  intf->handleCommandAck(cmd, handle);
-  intf->notifyOfExternalEvent();
+  TheAdapter->postCommandAck (cmd, handle);
 }
 
 static void ack_success (Command* cmd, AdapterExecInterface* intf)
@@ -189,35 +317,41 @@ static void ack_sent (Command* cmd, AdapterExecInterface* intf)
   ack_command (cmd, COMMAND_SENT_TO_SYSTEM, intf);
 }
 
-static void send_ack_once(CommandRecord& cr, bool skip=false)
+// Returns the new command's id, or -1 (having failed the command) if too many
+// commands are in progress.
+static int new_command (Command* cmd, AdapterExecInterface* intf)
 {
-  std::lock_guard<std::mutex> g(g_shared_mutex);
-  bool& sent_flag = std::get<CR_ACK_SENT>(cr);
-  if (!sent_flag)
-  {
-    if (!skip) {
-      ack_sent(std::get<CR_COMMAND>(cr), std::get<CR_ADAPTER>(cr));
-    }
-    sent_flag = true;
+  int id = Commands->allocate (CommandRecord { cmd, intf });
+  if (id < 0) {
+    ROS_ERROR ("PLEXIL Adapter: %d commands already in progress, "
+               "failing %s.", Commands->capacity(), cmd->getName().c_str());
+    ack_failure (cmd, intf);
+  }
+  return id;
+}
+
+// Acknowledge that the command was sent, unless it has already finished.
+static void send_ack_once (int id, Command* cmd, AdapterExecInterface* intf)
+{
+  if (Commands->beginSent (id)) {
+    ack_sent (cmd, intf);
+    Commands->endSent (id);
   }
 }
 
 static void command_status_callback (int id, bool success)
 {
-  auto it = CommandRegistry.find(id);
-  if (it == CommandRegistry.end())
-  {
-    ROS_ERROR_STREAM("command_status_callback: no command registered under id"
+  CommandRecord cr;
+  bool aborted;
+  if (! Commands->claim (id, cr, aborted)) {
+    ROS_ERROR_STREAM("command_status_callback: no command in progress under id "
                      << id);
     return;
   }
-
-  std::unique_ptr<CommandRecord>& cr = it->second;
-  Command* cmd = std::get<CR_COMMAND>(*cr);
-  AdapterExecInterface* intf = std::get<CR_ADAPTER>(*cr);
-  send_ack_once(*cr, true);
-  if (success) ack_success (cmd, intf);
-  else ack_failure (cmd, intf);
+  if (success) ack_success (cr.command, cr.adapter);
+  else ack_failure (cr.command, cr.adapter);
+  if (aborted) TheAdapter->postCommandAbortAck (cr.command, true);
+  Commands->release (id);
 }
 
 
@@ -257,17 +391,18 @@ static void log_debug (Command* cmd, AdapterExecInterface* intf)
 
 static void stow (Command* cmd, AdapterExecInterface* intf)
 {
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
-  OwInterface::instance()->stow (CommandId);
-  send_ack_once(*cr);
-
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
+  OwInterface::instance()->stow (id);
+  send_ack_once (id, cmd, intf);
 }
 
 static void unstow (Command* cmd, AdapterExecInterface* intf)
 {
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
-  OwInterface::instance()->unstow (CommandId);
-  send_ack_once(*cr);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
+  OwInterface::instance()->unstow (id);
+  send_ack_once (id, cmd, intf);
 }
 
 static void guarded_move (Command* cmd, AdapterExecInterface* intf)
@@ -281,10 +416,11 @@ static void guarded_move (Command* cmd, AdapterExecInterface* intf)
   args[4].getValue(dir_y);
   args[5].getValue(dir_z);
   args[6].getValue(search_distance);
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
   OwInterface::instance()->guardedMove (x, y, z, dir_x, dir_y, dir_z,
-                                        search_distance, CommandId);
-  send_ack_once(*cr);
+                                        search_distance, id);
+  send_ack_once (id, cmd, intf);
 }
 
 static void grind (Command* cmd, AdapterExecInterface* intf)
@@ -298,10 +434,11 @@ static void grind (Command* cmd, AdapterExecInterface* intf)
   args[3].getValue(length);
   args[4].getValue(parallel);
   args[5].getValue(ground_pos);
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
   OwInterface::instance()->grind(x, y, depth, length, parallel, ground_pos,
-                                 CommandId);
-  send_ack_once(*cr);
+                                 id);
+  send_ack_once (id, cmd, intf);
 }
 
 static void dig_circular (Command* cmd, AdapterExecInterface* intf)
@@ -314,10 +451,11 @@ static void dig_circular (Command* cmd, AdapterExecInterface* intf)
   args[2].getValue(depth);
   args[3].getValue(ground_position);
   args[4].getValue(parallel);
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
   OwInterface::instance()->digCircular(x, y, depth, ground_position, parallel,
-                                       CommandId);
-  send_ack_once(*cr);
+                                       id);
+  send_ack_once (id, cmd, intf);
 }
 
 static void dig_linear (Command* cmd, AdapterExecInterface* intf)
@@ -329,10 +467,11 @@ static void dig_linear (Command* cmd, AdapterExecInterface* intf)
   args[2].getValue(depth);
   args[3].getValue(length);
   args[4].getValue(ground_position);
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
   OwInterface::instance()->digLinear(x, y, depth, length, ground_position,
-                                     CommandId);
-  send_ack_once(*cr);
+                                     id);
+  send_ack_once (id, cmd, intf);
 }
 
 static void deliver (Command* cmd, AdapterExecInterface* intf)
@@ -342,9 +481,10 @@ static void deliver (Command* cmd, AdapterExecInterface* intf)
   args[0].getValue(x);
   args[1].getValue(y);
   args[2].getValue(z);
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
-  OwInterface::instance()->deliver (x, y, z, CommandId);
-  send_ack_once(*cr);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
+  OwInterface::instance()->deliver (x, y, z, id);
+  send_ack_once (id, cmd, intf);
 }
 
 static void tilt_antenna (Command* cmd, AdapterExecInterface* intf)
@@ -352,9 +492,10 @@ static void tilt_antenna (Command* cmd, AdapterExecInterface* intf)
   double degrees;
   const vector<Value>& args = cmd->getArgValues();
   args[0].getValue (degrees);
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
-  OwInterface::instance()->tiltAntenna (degrees, CommandId);
-  send_ack_once(*cr);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
+  OwInterface::instance()->tiltAntenna (degrees, id);
+  send_ack_once (id, cmd, intf);
 }
 
 static void pan_antenna (Command* cmd, AdapterExecInterface* intf)
@@ -362,24 +503,156 @@ static void pan_antenna (Command* cmd, AdapterExecInterface* intf)
   double degrees;
   const vector<Value>& args = cmd->getArgValues();
   args[0].getValue (degrees);
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
-  OwInterface::instance()->panAntenna (degrees, CommandId);
-  send_ack_once(*cr);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
+  OwInterface::instance()->panAntenna (degrees, id);
+  send_ack_once (id, cmd, intf);
+}
+
+static void point_antenna (Command* cmd, AdapterExecInterface* intf)
+{
+  double pan, tilt;
+  const vector<Value>& args = cmd->getArgValues();
+  args[0].getValue (pan);
+  args[1].getValue (tilt);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
+  OwInterface::instance()->pointAntenna (pan, tilt, id);
+  send_ack_once (id, cmd, intf);
+}
+
+static void take_panorama (Command* cmd, AdapterExecInterface* intf)
+{
+  double tilt_lo, tilt_hi, pan_lo, pan_hi, vert_overlap, horiz_overlap;
+  string completed;
+  const vector<Value>& args = cmd->getArgValues();
+  args[0].getValue (tilt_lo);
+  args[1].getValue (tilt_hi);
+  args[2].getValue (pan_lo);
+  args[3].getValue (pan_hi);
+  args[4].getValue (vert_overlap);
+  args[5].getValue (horiz_overlap);
+  args[6].getValue (completed);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
+  OwInterface::instance()->takePanorama (tilt_lo, tilt_hi, pan_lo, pan_hi,
+                                         vert_overlap, horiz_overlap,
+                                         completed, id);
+  send_ack_once (id, cmd, intf);
 }
 
 static void take_picture (Command* cmd, AdapterExecInterface* intf)
 {
-  std::unique_ptr<CommandRecord>& cr = new_command_record(cmd, intf);
-  OwInterface::instance()->takePicture (CommandId);
-  send_ack_once(*cr);
+  int id = new_command (cmd, intf);
+  if (id < 0) return;
+  OwInterface::instance()->takePicture (id);
+  send_ack_once (id, cmd, intf);
 }
 
+static void trigger_flipped (const string& trigger_name, bool active);
 
-////////////////////// Publish/subscribe support ////////////////////////////
+// Register a threshold trigger on a numeric state; see telemetry_trigger.h.
+// Arguments: trigger name, state name, comparator, threshold, persistence.
+// The trigger is evaluated at once against the state's current value, when
+// that can be looked up.
+static void add_trigger (Command* cmd, AdapterExecInterface* intf)
+{
+  string name, state_name, comparator_text;
+  double threshold, persistence;
+  Comparator comparator;
+  const vector<Value>& args = cmd->getArgValues();
+  if (args.size() != 5 ||
+      ! args[0].getValue (name) ||
+      ! args[1].getValue (state_name) ||
+      ! args[2].getValue (comparator_text) ||
+      ! args[3].getValue (threshold) ||
+      ! args[4].getValue (persistence) ||
+      persistence < 0) {
+    ROS_ERROR ("add_trigger: requires name, state, comparator, threshold, "
+               "and non-negative persistence.");
+    ack_failure (cmd, intf);
+    return;
+  }
+  if (! parseComparator (comparator_text, comparator)) {
+    ROS_ERROR ("add_trigger: unknown comparator %s", comparator_text.c_str());
+    ack_failure (cmd, intf);
+    return;
+  }
 
-// A localized handle on the adapter, which allows a
-// decoupling between the sample system and adapter.
-static OwAdapter* TheAdapter;
+  addTrigger (name, state_name, comparator, threshold, persistence,
+              trigger_flipped);
+
+  Value current;
+  double value;
+  if (lookup (state_name, EmptyArgs, current) && current.getValue (value)) {
+    evaluateTriggers (state_name, value, ros::Time::now().toSec(),
+                      trigger_flipped);
+  }
+  ack_success (cmd, intf);
+}
+
+static void remove_trigger (Command* cmd, AdapterExecInterface* intf)
+{
+  string name;
+  const vector<Value>& args = cmd->getArgValues();
+  if (args.size() != 1 || ! args[0].getValue (name)) {
+    ROS_ERROR ("remove_trigger: requires a trigger name.");
+    ack_failure (cmd, intf);
+    return;
+  }
+  if (! removeTrigger (name, trigger_flipped)) {
+    ROS_WARN ("remove_trigger: no trigger named %s", name.c_str());
+    ack_failure (cmd, intf);
+    return;
+  }
+  ack_success (cmd, intf);
+}
+
+// Set the timeout, in seconds, of a lander operation (e.g. "Grind") for its
+// subsequent commands; 0 removes the limit.
+static void set_operation_timeout (Command* cmd, AdapterExecInterface* intf)
+{
+  string opname;
+  double seconds;
+  const vector<Value>& args = cmd->getArgValues();
+  if (args.size() != 2 ||
+      ! args[0].getValue (opname) ||
+      ! args[1].getValue (seconds)) {
+    ROS_ERROR ("set_operation_timeout: requires operation name and seconds.");
+    ack_failure (cmd, intf);
+    return;
+  }
+  if (! OwInterface::instance()->setOperationTimeout (opname, seconds)) {
+    ROS_ERROR ("set_operation_timeout: invalid timeout %f for operation %s",
+               seconds, opname.c_str());
+    ack_failure (cmd, intf);
+    return;
+  }
+  ack_success (cmd, intf);
+}
+
+// Set the order in which subsequent panoramas take their tiles, by name:
+// Serpentine, RowMajor, or MinimumSlew (see tile_scheduler.h).
+static void set_panorama_ordering (Command* cmd, AdapterExecInterface* intf)
+{
+  string ordering;
+  const vector<Value>& args = cmd->getArgValues();
+  if (args.size() != 1 || ! args[0].getValue (ordering)) {
+    ROS_ERROR ("set_panorama_ordering: requires an ordering name.");
+    ack_failure (cmd, intf);
+    return;
+  }
+  if (! OwInterface::instance()->setPanoramaOrdering (ordering)) {
+    ROS_ERROR ("set_panorama_ordering: unknown ordering %s", ordering.c_str());
+    ack_failure (cmd, intf);
+    return;
+  }
+  ack_success (cmd, intf);
+}
+
+
+
+////////////////////// Publish/subscribe support ////////////////////////////
 
 static State createState (const string& state_name, const vector<Value>& value)
 {
@@ -409,8 +682,21 @@ static void receiveBool (const string& state_name, bool val)
              vector<Value> (1, val));
 }
 
+static void trigger_flipped (const string& trigger_name, bool active)
+{
+  debugMsg("OwAdapter:trigger", " " << trigger_name << " now "
+           << (active ? "true" : "false"));
+  propagate (createState ("Trigger", vector<Value> (1, trigger_name)),
+             vector<Value> (1, active));
+}
+
 static void receiveDouble (const string& state_name, double val)
 {
+  if (anyTriggers()) {
+    evaluateTriggers (state_name, val, ros::Time::now().toSec(),
+                      trigger_flipped);
+  }
+  if (! passesTelemetryFilter (state_name, val)) return;
   propagate (createState(state_name, EmptyArgs),
              vector<Value> (1, val));
 }
@@ -429,6 +715,26 @@ static void receiveBoolString (const string& state_name,
              vector<Value> (1, val));
 }
 
+// Value changes held back while a publish batch is open on this thread.
+struct PendingChanges
+{
+  int depth = 0;  // nesting level of open batches
+  vector<std::pair<State, Value>> changes;
+};
+
+static thread_local PendingChanges Pending;
+
+static void batch_boundary (bool begin)
+{
+  if (begin) {
+    ++Pending.depth;
+    return;
+  }
+  if (--Pending.depth > 0 || Pending.changes.empty()) return;
+  TheAdapter->propagateValueChanges (Pending.changes);
+  Pending.changes.clear();
+}
+
 void OwAdapter::propagateValueChange (const State& state,
                                        const vector<Value>& vals) const
 {
@@ -437,17 +743,178 @@ void OwAdapter::propagateValueChange (const State& state,
     return;
   }
 
-  debugMsg("OwAdapter:propagateValueChange", " sending " << state);
-  m_execInterface.handleValueChange (state, vals.front());
-  m_execInterface.notifyOfExternalEvent();
+  if (Pending.depth > 0) {
+    debugMsg("OwAdapter:propagateValueChange", " batching " << state);
+    Pending.changes.emplace_back (state, vals.front());
+    return;
+  }
+
+  debugMsg("OwAdapter:propagateValueChange", " queueing " << state);
+  ExecUpdate update;
+  update.changes.emplace_back (state, vals.front());
+  post (std::move (update));
+}
+
+void OwAdapter::propagateValueChanges
+(const vector<std::pair<State, Value>>& changes) const
+{
+  debugMsg("OwAdapter:propagateValueChanges", " queueing "
+           << changes.size() << " changes");
+  ExecUpdate update;
+  update.changes = changes;
+  post (std::move (update));
+}
+
+void OwAdapter::postCommandAck (Command* cmd, CommandHandleValue handle) const
+{
+  ExecUpdate update;
+  update.kind = ExecUpdate::Ack;
+  update.command = cmd;
+  update.ack = handle;
+  post (std::move (update));
+}
+
+void OwAdapter::postCommandReturn (Command* cmd, const Value& value) const
+{
+  ExecUpdate update;
+  update.kind = ExecUpdate::Return;
+  update.command = cmd;
+  update.returnValue = value;
+  post (std::move (update));
+}
+
+void OwAdapter::postCommandAbortAck (Command* cmd, bool success) const
+{
+  ExecUpdate update;
+  update.kind = ExecUpdate::AbortAck;
+  update.command = cmd;
+  update.abortSucceeded = success;
+  post (std::move (update));
+}
+
+int OwAdapter::execQueueDepth () const
+{
+  return m_updates.size();
+}
+
+void OwAdapter::post (ExecUpdate&& update) const
+{
+  // A command update posted inside a publish batch carries the changes the
+  // batch has held so far, which are delivered first, so the executive never
+  // sees e.g. an operation's success before its Running state goes false.
+  if (update.kind != ExecUpdate::ValueChanges && Pending.depth > 0 &&
+      ! Pending.changes.empty()) {
+    update.changes.swap (Pending.changes);
+    Pending.changes.clear();
+  }
+  m_updates.push (std::move (update));
+  // Wake the dispatcher only if it is asleep.  Paired with the store of
+  // m_dispatcherWaiting and the emptiness check in dispatch().
+  if (m_dispatcherWaiting.load()) {
+    std::lock_guard<std::mutex> lock (m_wakeMutex);
+    m_wake.notify_one();
+  }
+}
+
+void OwAdapter::deliverUpdate (const ExecUpdate& update)
+{
+  for (const auto& change : update.changes) {
+    m_execInterface.handleValueChange (change.first, change.second);
+  }
+  switch (update.kind) {
+  case ExecUpdate::ValueChanges:
+    break;
+  case ExecUpdate::Ack:
+    m_execInterface.handleCommandAck (update.command, update.ack);
+    break;
+  case ExecUpdate::Return:
+    m_execInterface.handleCommandReturn (update.command, update.returnValue);
+    break;
+  case ExecUpdate::AbortAck:
+    m_execInterface.handleCommandAbortAck (update.command,
+                                           update.abortSucceeded);
+    break;
+  }
+}
+
+void OwAdapter::dispatch ()
+{
+  // The only thread, besides the executive's own, that calls into the exec
+  // interface.  Everything queued since the last pass is delivered with a
+  // single notification.
+  while (true) {
+    int delivered = 0;
+    ExecUpdate update;
+    while (m_updates.pop (update)) {
+      deliverUpdate (update);
+      ++delivered;
+    }
+    if (delivered > 0) {
+      debugMsg("OwAdapter:dispatch", " delivered " << delivered << " updates");
+      m_execInterface.notifyOfExternalEvent();
+    }
+
+    std::unique_lock<std::mutex> lock (m_wakeMutex);
+    m_dispatcherWaiting.store (true);
+    m_wake.wait (lock, [this] {
+        return m_dispatcherStopping.load() || ! m_updates.empty();
+      });
+    m_dispatcherWaiting.store (false);
+    if (m_dispatcherStopping.load() && m_updates.empty()) return;
+  }
+}
+
+void OwAdapter::stopDispatcher ()
+{
+  if (! m_dispatcher.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock (m_wakeMutex);
+    m_dispatcherStopping.store (true);
+  }
+  m_wake.notify_one();
+  m_dispatcher.join();
 }
 
 bool OwAdapter::isStateSubscribed(const State& state) const
 {
+  std::lock_guard<std::mutex> lock (m_subscriptionMutex);
   return m_subscribedStates.find(state) != m_subscribedStates.end();
 }
 
 
+//////////////////////////// Telemetry filters ////////////////////////////////
+
+// Filters are configured in the adapter's element of the interface
+// configuration file (ow-config.xml), one element per state, e.g.
+//
+//   <TelemetryFilter State="StateOfCharge" AbsoluteDeadband="0.001"/>
+//   <TelemetryFilter State="*Effort" RelativeDeadband="0.05" MaxRate="10"
+//                    PublishOnSignChange="false"/>
+//
+// See telemetry_filter.h for the meaning of each attribute.
+
+static void configure_telemetry_filters (const pugi::xml_node& config)
+{
+  for (pugi::xml_node elt = config.child ("TelemetryFilter");
+       elt;
+       elt = elt.next_sibling ("TelemetryFilter")) {
+    string state_name = elt.attribute ("State").as_string();
+    if (state_name.empty()) {
+      ROS_ERROR ("PLEXIL Adapter: TelemetryFilter without State, ignored.");
+      continue;
+    }
+    TelemetryFilterSpec spec;
+    spec.absoluteDeadband = elt.attribute ("AbsoluteDeadband").as_double (0);
+    spec.relativeDeadband = elt.attribute ("RelativeDeadband").as_double (0);
+    spec.maxRate = elt.attribute ("MaxRate").as_double (0);
+    spec.publishOnSignChange =
+      elt.attribute ("PublishOnSignChange").as_bool (true);
+    setTelemetryFilter (state_name, spec);
+    debugMsg("OwAdapter:initialize", " filtering " << state_name);
+  }
+}
+
+
 ///////////////////////////// Member functions //////////////////////////////////
 
 
@@ -460,6 +927,7 @@ OwAdapter::OwAdapter(AdapterExecInterface& execInterface,
 
 OwAdapter::~OwAdapter ()
 {
+  stopDispatcher();
 }
 
 bool OwAdapter::initialize()
@@ -478,13 +946,31 @@ bool OwAdapter::initialize()
   g_configuration->registerCommandHandler("deliver", deliver);
   g_configuration->registerCommandHandler("tilt_antenna", tilt_antenna);
   g_configuration->registerCommandHandler("pan_antenna", pan_antenna);
+  g_configuration->registerCommandHandler("point_antenna", point_antenna);
   g_configuration->registerCommandHandler("take_picture", take_picture);
+  g_configuration->registerCommandHandler("take_panorama", take_panorama);
+  g_configuration->registerCommandHandler("add_trigger", add_trigger);
+  g_configuration->registerCommandHandler("remove_trigger", remove_trigger);
+  g_configuration->registerCommandHandler("set_operation_timeout",
+                                          set_operation_timeout);
+  g_configuration->registerCommandHandler("set_panorama_ordering",
+                                          set_panorama_ordering);
+
+  // The most commands that may be in progress at once, from the adapter's
+  // element of the interface configuration, e.g. <Adapter ... MaxCommands="64">.
+  Commands.reset (new CommandSlab<CommandRecord>
+                  (getXml().attribute ("MaxCommands")
+                   .as_int (DefaultCommandCapacity)));
+
+  initialize_lookups();
+  configure_telemetry_filters (getXml());
 
   TheAdapter = this;
   setSubscriber (receiveBool);
   setSubscriber (receiveString);
   setSubscriber (receiveDouble);
   setSubscriber (receiveBoolString);
+  setBatchHandler (batch_boundary);
   OwInterface::instance()->setCommandStatusCallback (command_status_callback);
   debugMsg("OwAdapter", " initialized.");
   return true;
@@ -492,12 +978,17 @@ bool OwAdapter::initialize()
 
 bool OwAdapter::start()
 {
+  if (! m_dispatcher.joinable()) {
+    m_dispatcherStopping.store (false);
+    m_dispatcher = std::thread (&OwAdapter::dispatch, this);
+  }
   debugMsg("OwAdapter", " started.");
   return true;
 }
 
 bool OwAdapter::stop()
 {
+  stopDispatcher();
   debugMsg("OwAdapter", " stopped.");
   return true;
 }
@@ -510,14 +1001,28 @@ bool OwAdapter::reset()
 
 bool OwAdapter::shutdown()
 {
+  stopDispatcher();
   debugMsg("OwAdapter", " shut down.");
   return true;
 }
 
 void OwAdapter::invokeAbort(Command *cmd)
 {
-  ROS_ERROR("Cannot abort command %s, not implemented, ignoring.",
-            cmd->getName().c_str());
+  // The abort is acknowledged when the command finishes, which the lander
+  // operation is asked to hasten.  A command not in progress (finished, or
+  // one that completes immediately) has nothing to abort.  Called on the
+  // executive's thread, which allocates commands, as CommandSlab::find requires.
+  int id = Commands->find ([cmd] (const CommandRecord& cr) {
+      return cr.command == cmd;
+    });
+  if (id < 0 || ! Commands->requestAbort (id)) {
+    debugMsg("OwAdapter:invokeAbort", " " << cmd->getName()
+             << " not in progress");
+    postCommandAbortAck (cmd, true);
+    return;
+  }
+  ROS_INFO ("Aborting command %s", cmd->getName().c_str());
+  OwInterface::instance()->abortOperation (id);
 }
 
 
@@ -540,6 +1045,7 @@ void OwAdapter::lookupNow (const State& state, StateCacheEntry& entry)
 void OwAdapter::subscribe(const State& state)
 {
   debugMsg("OwAdapter:subscribe", " to state " << state.name());
+  std::lock_guard<std::mutex> lock (m_subscriptionMutex);
   m_subscribedStates.insert(state);
 }
 
@@ -547,6 +1053,7 @@ void OwAdapter::subscribe(const State& state)
 void OwAdapter::unsubscribe (const State& state)
 {
   debugMsg("OwAdapter:unsubscribe", " from state " << state.name());
+  std::lock_guard<std::mutex> lock (m_subscriptionMutex);
   m_subscribedStates.erase(state);
 }
 
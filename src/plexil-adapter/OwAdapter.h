@@ -12,7 +12,15 @@
 #include "InterfaceAdapter.hh"
 #include "Value.hh"
 
+#include "mpsc_queue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <set>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace PLEXIL;
 
@@ -36,9 +44,49 @@ public:
   virtual void unsubscribe(const State& state);
   void propagateValueChange (const State&, const std::vector<Value>&) const;
 
+  // Deliver several value changes with a single exec notification.
+  void propagateValueChanges
+    (const std::vector<std::pair<State, Value>>&) const;
+
+  // Command acks, return values, and abort acks, from any thread.
+  void postCommandAck (Command*, CommandHandleValue) const;
+  void postCommandReturn (Command*, const Value&) const;
+  void postCommandAbortAck (Command*, bool success) const;
+
+  // Number of updates waiting for delivery to the executive.
+  int execQueueDepth () const;
+
 private:
+  // Value changes, acks, and return values are not handed to the executive
+  // by the threads producing them, but queued (lock-free) and delivered in
+  // batches by a single dispatcher thread, run between start() and stop().
+  struct ExecUpdate
+  {
+    enum Kind { ValueChanges, Ack, Return, AbortAck } kind = ValueChanges;
+    std::vector<std::pair<State, Value>> changes;
+    Command* command = nullptr;     // for all but ValueChanges
+    CommandHandleValue ack = NO_COMMAND_HANDLE;
+    Value returnValue;
+    bool abortSucceeded = false;
+  };
+
+  void post (ExecUpdate&&) const;
+  void deliverUpdate (const ExecUpdate&);
+  void dispatch ();
+  void stopDispatcher ();
+
+  // States the executive subscribes to.  Read by the threads producing
+  // telemetry, written by the executive's.
   bool isStateSubscribed(const State& state) const;
   std::set<State> m_subscribedStates;
+  mutable std::mutex m_subscriptionMutex;
+
+  mutable MpscQueue<ExecUpdate> m_updates;
+  std::thread m_dispatcher;
+  std::atomic<bool> m_dispatcherStopping { false };
+  mutable std::atomic<bool> m_dispatcherWaiting { false };
+  mutable std::mutex m_wakeMutex;
+  mutable std::condition_variable m_wake;
 };
 
 extern "C" {
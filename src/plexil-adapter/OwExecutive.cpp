@@ -5,6 +5,8 @@
 // ROS
 #include <ros/ros.h>
 #include <ros/package.h>
+#include <ros/callback_queue.h>
+#include <rosgraph_msgs/Clock.h>
 #include <std_msgs/Float64.h>
 
 // OW
@@ -93,6 +95,44 @@ bool OwExecutive::runPlan (const string& filename)
 }
 
 
+static void clock_callback (const rosgraph_msgs::Clock::ConstPtr&)
+{
+  // Nothing to do: roscpp updates ROS time itself.  Receiving the message is
+  // what wakes waitForClock().
+}
+
+bool OwExecutive::waitForClock (double timeout, const std::atomic<bool>* stop)
+{
+  if (! ros::Time::isSimTime() || ! ros::Time::now().isZero()) return true;
+
+  // Block on a private subscription to the clock, so that we wake on the
+  // first message instead of polling.
+  ros::NodeHandle nh;
+  ros::CallbackQueue queue;
+  nh.setCallbackQueue (&queue);
+  ros::Subscriber clock_sub = nh.subscribe ("/clock", 1, clock_callback);
+
+  // Longest single wait, so that shutdown or a stop is noticed.
+  const ros::WallDuration slice (1.0);
+  ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration (timeout);
+
+  while (ros::ok() && ros::Time::now().isZero()) {
+    if (stop && stop->load()) return false;
+    ros::WallDuration wait = slice;
+    if (timeout > 0) {
+      ros::WallDuration remaining = deadline - ros::WallTime::now();
+      if (remaining <= ros::WallDuration (0)) {
+        ROS_ERROR ("No clock received after %f seconds.", timeout);
+        return false;
+      }
+      if (remaining < wait) wait = remaining;
+    }
+    queue.callAvailable (wait);
+  }
+  return ros::ok();
+}
+
+
 // PLEXIL application setup functions start here.
 
 static bool plexilInitializeInterfaces()
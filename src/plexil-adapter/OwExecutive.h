@@ -10,6 +10,7 @@
 // The implementation embeds a PLEXIL executive and application.  Because only
 // one PLEXIL executive can run in one process, this class is a singleton.
 
+#include <atomic>
 #include <string>
 
 class OwExecutive
@@ -25,6 +26,13 @@ class OwExecutive
   bool initialize ();
   bool runPlan (const std::string& filename);
 
+  // Wait until ROS time is live, i.e. until the first /clock message when
+  // using simulation time.  Returns as soon as it arrives, or false after
+  // 'timeout' seconds; a timeout of zero waits indefinitely.  Also returns
+  // false, within a second, once 'stop' (if given) is set.
+  bool waitForClock (double timeout = 0,
+                     const std::atomic<bool>* stop = nullptr);
+
  private:
   static OwExecutive* m_instance;
 };
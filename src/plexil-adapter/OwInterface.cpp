@@ -6,6 +6,11 @@
 #include "OwInterface.h"
 #include "subscriber.h"
 #include "joint_support.h"
+#include "joint_state_decoder.h"
+#include "telemetry_store.h"
+#include "action_executor.h"
+#include "timer_wheel.h"
+#include "panorama_engine.h"
 
 // ROS
 #include <std_msgs/Float64.h>
@@ -13,14 +18,12 @@
 #include <std_msgs/Empty.h>
 
 // C++
-#include <set>
 #include <map>
-#include <thread>
+#include <atomic>
+#include <chrono>
 #include <functional>
-using std::set;
+#include <mutex>
 using std::map;
-using std::thread;
-using std::ref;
 
 // C
 #include <cmath>  // for M_PI and fabs
@@ -44,8 +47,6 @@ static bool within_tolerance (double val1, double val2, double tolerance)
 
 static void (* CommandStatusCallback) (int,bool);
 
-const double PanTiltTimeout = 5.0; // seconds, made up
-
 // Lander operation names.  In general these match those used in PLEXIL and
 // ow_lander.
 
@@ -55,10 +56,12 @@ const string Op_DigLinear         = "DigLinear";
 const string Op_Deliver           = "Deliver";
 const string Op_PanAntenna        = "PanAntenna";
 const string Op_TiltAntenna       = "TiltAntenna";
+const string Op_PointAntenna      = "PointAntenna";
 const string Op_Grind             = "Grind";
 const string Op_Stow              = "Stow";
 const string Op_Unstow            = "Unstow";
 const string Op_TakePicture       = "TakePicture";
+const string Op_TakePanorama      = "TakePanorama";
 
 enum LanderOps {
   GuardedMove,
@@ -67,291 +70,477 @@ enum LanderOps {
   Deliver,
   Pan,
   Tilt,
+  PointAntenna,
   Grind,
   Stow,
   Unstow,
-  TakePicture
+  TakePicture,
+  TakePanorama
 };
 
 static std::vector<string> LanderOpNames =
   { Op_GuardedMove, Op_DigCircular, Op_DigLinear, Op_Deliver,
-    Op_PanAntenna, Op_TiltAntenna, Op_Grind, Op_Stow, Op_Unstow, Op_TakePicture
+    Op_PanAntenna, Op_TiltAntenna, Op_PointAntenna, Op_Grind, Op_Stow,
+    Op_Unstow, Op_TakePicture, Op_TakePanorama
   };
 
-// NOTE: The following map *should* be thread-safe, according to C++11 docs and
-// in particular because map entries are never added or deleted, and the code
-// insures that each entry can be read/written by only one thread.  (The map
-// itself can be read/written by multiple threads concurrently).
-
 // Unused operation ID that signifies idle lander operation.
 #define IDLE_ID (-1)
 
-static map<string, int> Running
-{
-  { Op_GuardedMove, IDLE_ID },
-  { Op_DigCircular, IDLE_ID },
-  { Op_DigLinear, IDLE_ID },
-  { Op_Deliver, IDLE_ID },
-  { Op_PanAntenna, IDLE_ID },
-  { Op_TiltAntenna, IDLE_ID },
-  { Op_Grind, IDLE_ID },
-  { Op_Stow, IDLE_ID },
-  { Op_Unstow, IDLE_ID },
-  { Op_TakePicture, IDLE_ID }
-};
+// The ID of the command running each operation, or IDLE_ID.  Entries are
+// never added or deleted after initialization, so the map itself needs no
+// lock.  An operation starts by swapping its entry from IDLE_ID to the command
+// ID and finishes by swapping it back, so that when several parties try to
+// finish it (completion, abort, timeout), exactly one does.
+
+static map<string, std::atomic<int>> Running = [] {
+  map<string, std::atomic<int>> running;
+  for (const auto& name : LanderOpNames) running[name] = IDLE_ID;
+  return running;
+}();
 
 static bool is_lander_operation (const string& name)
 {
   return Running.find (name) != Running.end();
 }
 
-static bool mark_operation_running (const string& name, int id)
+// Operations that can't run at the same time, as they use the same equipment.
+static const map<string, std::vector<string>> Conflicts
 {
-  if (Running.at (name) != IDLE_ID) {
-    ROS_WARN ("%s already running, ignoring duplicate request.", name.c_str());
-    return false;
+  { Op_TakePanorama, { Op_PanAntenna, Op_TiltAntenna, Op_PointAntenna,
+                       Op_TakePicture } },
+  { Op_PanAntenna, { Op_PointAntenna, Op_TakePanorama } },
+  { Op_TiltAntenna, { Op_PointAntenna, Op_TakePanorama } },
+  { Op_PointAntenna, { Op_PanAntenna, Op_TiltAntenna, Op_TakePanorama } },
+  { Op_TakePicture, { Op_TakePanorama } }
+};
+
+static const string* running_conflict (const string& name)
+{
+  auto entry = Conflicts.find (name);
+  if (entry == Conflicts.end()) return nullptr;
+  for (const auto& other : entry->second) {
+    if (Running.at (other) != IDLE_ID) return &other;
   }
-  Running.at (name) = id;
-  publish ("Running", true, name);
-  return true;
+  return nullptr;
+}
+
+// Topics subscribed only on demand, while certain operations run.  Filled in
+// by OwInterface::initialize() and read-only thereafter.
+
+static map<string, LazySubscription*> OperationTopics;
+
+static void need_topic (map<string, LazySubscription*>& topics,
+                        const string& name, bool needed)
+{
+  auto entry = topics.find (name);
+  if (entry == topics.end()) return;
+  if (needed) entry->second->acquire();
+  else entry->second->release();
+}
+
+//////////////////// Operation timeouts ////////////////////////
+
+// An operation still running this many seconds (ROS time) after it started
+// is stopped and fails; 0 means it may run indefinitely.  These defaults may
+// be overridden by the node's private parameters timeouts/<operation> and, at
+// run time, by the set_operation_timeout command.  NOTE: made up.
+
+static map<string, std::atomic<double>> OperationTimeouts = [] {
+  map<string, std::atomic<double>> timeouts;
+  for (const auto& name : LanderOpNames) timeouts[name] = 0;
+  timeouts[Op_PanAntenna] = 5;
+  timeouts[Op_TiltAntenna] = 5;
+  timeouts[Op_PointAntenna] = 5;
+  timeouts[Op_TakePicture] = 10;
+  return timeouts;
+}();
+
+// All deadlines are kept by one timer wheel, advanced by a ROS timer on the
+// action spinner (see OwInterface::initialize).
+
+const double WatchdogTick = 0.1;  // seconds
+const int WatchdogSlots = 1024;   // one turn is about 100 seconds
+
+static TimerWheel Watchdog (WatchdogTick, WatchdogSlots);
+
+// The watchdog timer of each running operation that has one, by command ID.
+static map<int, TimerWheel::TimerId> WatchdogTimers;
+static std::mutex WatchdogMutex;
+
+static void stop_watchdog (int id)
+{
+  TimerWheel::TimerId timer = 0;
+  {
+    std::lock_guard<std::mutex> lock (WatchdogMutex);
+    auto entry = WatchdogTimers.find (id);
+    if (entry == WatchdogTimers.end()) return;
+    timer = entry->second;
+    WatchdogTimers.erase (entry);
+  }
+  Watchdog.cancel (timer);
 }
 
-static void mark_operation_finished (const string& name, int id)
+static void mark_operation_finished (const string& name, int id,
+                                     bool success = true)
 {
-  if (! Running.at (name) == IDLE_ID) {
-    ROS_WARN ("%s was not running. Should never happen.", name.c_str());
+  int running = id;
+  if (id == IDLE_ID ||
+      ! Running.at (name).compare_exchange_strong (running, IDLE_ID)) {
+    // E.g. the late result of an action that was aborted or timed out.
+    ROS_DEBUG ("%s (command %d) already finished.", name.c_str(), id);
+    return;
+  }
+  stop_watchdog (id);
+  need_topic (OperationTopics, name, false);
+  {
+    PublishBatch batch;
+    publish ("Running", false, name);
+    publish ("Finished", true, name);
   }
-  Running.at (name) = IDLE_ID;
-  publish ("Running", false, name);
-  publish ("Finished", true, name);
-  if (id != IDLE_ID) CommandStatusCallback (id, true);
+  CommandStatusCallback (id, success);
 }
 
+static void operation_timed_out (const string& name, int id, double timeout)
+{
+  if (Running.at (name) != id) return;
+  ROS_ERROR ("%s timed out after %.1f seconds.", name.c_str(), timeout);
 
-//////////////////// Fault Support ////////////////////////
+  // Stop the operation as an abort would, but don't wait for a hung action
+  // server to confirm it.
+  OwInterface::instance()->abortOperation (id);
+  mark_operation_finished (name, id, false);
+}
 
-static void monitor_for_faults (const string& opname)
+static void start_watchdog (const string& name, int id)
 {
-  // This (threaded) function was formerly used for operation-specific fault
-  // monitoring, using a mechanism that has been removed, which was direct
-  // inspection of the fault injection ROS parameters.  TBD whether it will be
-  // used again, but leaving it here for now.
+  double timeout = OperationTimeouts.at (name);
+  if (timeout <= 0) return;
+  TimerWheel::TimerId timer = Watchdog.schedule
+    (ros::Time::now().toSec() + timeout,
+     [name, id, timeout] () { operation_timed_out (name, id, timeout); });
+  {
+    std::lock_guard<std::mutex> lock (WatchdogMutex);
+    WatchdogTimers[id] = timer;
+  }
+  // The operation may have finished before its timer was recorded.
+  if (Running.at (name) != id) stop_watchdog (id);
+}
 
-  //  using namespace std::chrono_literals;
-  //  while (Running.at (opname) != IDLE_ID) {
-  //    std::this_thread::sleep_for (1s);
-  //  }
+static bool mark_operation_running (const string& name, int id)
+{
+  int idle = IDLE_ID;
+  if (! Running.at (name).compare_exchange_strong (idle, id)) {
+    ROS_WARN ("%s already running, ignoring duplicate request.", name.c_str());
+    // The duplicate is finished, failed, so that its command completes.
+    CommandStatusCallback (id, false);
+    return false;
+  }
+  if (const string* other = running_conflict (name)) {
+    Running.at (name) = IDLE_ID;
+    ROS_WARN ("%s can't run during %s, ignoring request.",
+              name.c_str(), other->c_str());
+    CommandStatusCallback (id, false);
+    return false;
+  }
+  need_topic (OperationTopics, name, true);
+  publish ("Running", true, name);
+  start_watchdog (name, id);
+  return true;
 }
 
+
 /////////////////////////// Joint/Torque Support ///////////////////////////////
 
-static set<string> JointsAtHardTorqueLimit { };
-static set<string> JointsAtSoftTorqueLimit { };
-
-static map<string, Joint> JointMap {
-  // ROS JointStates message name -> type
-  { "j_shou_yaw", Joint::shoulder_yaw },
-  { "j_shou_pitch", Joint::shoulder_pitch },
-  { "j_prox_pitch", Joint::proximal_pitch },
-  { "j_dist_pitch", Joint::distal_pitch },
-  { "j_hand_yaw", Joint::hand_yaw },
-  { "j_scoop_yaw", Joint::scoop_yaw },
-  { "j_ant_pan", Joint::antenna_pan },
-  { "j_ant_tilt", Joint::antenna_tilt },
-  { "j_grinder", Joint::grinder }
-};
+static TorqueLimitState TorqueLimits;
 
-static map<Joint, JointProperties> JointPropMap {
-  // NOTE: Torque limits are made up, and there may be a better place for these
-  // later.  Assuming that only magnitude matters.
-
-  { Joint::shoulder_yaw,   { "j_shou_yaw", "ShoulderYaw", 60, 80 }},
-  { Joint::shoulder_pitch, { "j_shou_pitch", "ShoulderPitch", 60, 80 }},
-  { Joint::proximal_pitch, { "j_prox_pitch", "ProximalPitch", 60, 80 }},
-  { Joint::distal_pitch,   { "j_dist_pitch", "DistalPitch", 60, 80 }},
-  { Joint::hand_yaw,       { "j_hand_yaw", "HandYaw", 60, 80 }},
-  { Joint::scoop_yaw,      { "j_scoop_yaw", "ScoopYaw", 60, 80 }},
-  { Joint::antenna_pan,    { "j_ant_pan", "AntennaPan", 30, 30 }},
-  { Joint::antenna_tilt,   { "j_ant_tilt", "AntennaTilt", 30, 30 }},
-  { Joint::grinder,        { "j_grinder", "Grinder", 30, 30 }}
-};
+// All telemetry read by the executive.  See telemetry_store.h.
+static TelemetryStore Telemetry;
 
-static map<Joint, JointTelemetry> JointTelemetryMap { };
+// Recent telemetry, for windowed statistics.  See telemetry_history.h.
+// Capacities are set in OwInterface::initialize().
+static TelemetryHistory JointHistory[NumJoints][3];
+static TelemetryHistory PowerHistory[static_cast<int>(PowerQuantity::Count)];
+
+static TelemetryHistory& joint_history (Joint joint, JointQuantity quantity)
+{
+  return JointHistory[jointIndex (joint)][static_cast<int>(quantity)];
+}
+
+static TelemetryHistory& power_history (PowerQuantity quantity)
+{
+  return PowerHistory[static_cast<int>(quantity)];
+}
 
 static void handle_overtorque (Joint joint, double effort)
 {
   // For now, torque is just effort (Newton-meter), and overtorque is specific
   // to the joint.
 
-  string joint_name = JointPropMap[joint].plexilName;
-
-  if (fabs(effort) >= JointPropMap[joint].hardTorqueLimit) {
-    JointsAtHardTorqueLimit.insert (joint_name);
-  }
-  else if (fabs(effort) >= JointPropMap[joint].softTorqueLimit) {
-    JointsAtSoftTorqueLimit.insert(joint_name);
-  }
-  else {
-    JointsAtHardTorqueLimit.erase (joint_name);
-    JointsAtSoftTorqueLimit.erase (joint_name);
-  }
+  const JointProperties& props = jointProperties (joint);
+  double now = ros::Time::now().toSec();
+  TorqueLimits.update (joint, props, effort, now,
+                       [&] (TorqueLimit limit, bool reached) {
+      bool hard = limit == TorqueLimit::Hard;
+      if (reached) {
+        ROS_WARN ("%s reached its %s torque limit (effort %.1f).",
+                  props.plexilName.c_str(), hard ? "hard" : "soft", effort);
+      }
+      else {
+        ROS_INFO ("%s back within its %s torque limit.",
+                  props.plexilName.c_str(), hard ? "hard" : "soft");
+      }
+      publish (hard ? "HardTorqueLimitReached" : "SoftTorqueLimitReached",
+               reached, props.plexilName);
+    });
 }
 
-static void handle_joint_fault (Joint joint, int joint_index,
-                                const sensor_msgs::JointState::ConstPtr& msg)
+static void handle_joint_fault (Joint joint, double effort)
 {
   // NOTE: For now, the only fault is overtorque.
-  handle_overtorque (joint, msg->effort[joint_index]);
+  handle_overtorque (joint, effort);
 }
 
-template <typename T1, typename T2>
-void OwInterface::faultCallback (T1 msg_val, T2& fmap,
-                                 const string& component)
+// Decoder for /joint_states; only the joint_states subscriber uses these.
+static JointStateDecoder JointStates (rosNameToJoint);
+static JointStateBuffer JointStateValues;
+
+// Takes panoramas (see OwInterface::takePanorama).  Driven by antenna joint
+// states and camera events; created by OwInterface::initialize().
+static std::unique_ptr<PanoramaEngine> Panorama;
+
+void OwInterface::faultCallback (uint64_t msg_val, FaultTable& faults,
+                                 const string& state_name)
 {
-  for (auto const& entry : fmap) {
-    string key = entry.first;
-    T1 value = entry.second.first;
-    bool fault_active = entry.second.second;
-    bool faulty = (msg_val & value) == value;
-    if (!fault_active && faulty) {
-      ROS_WARN ("Fault in %s: %s", component.c_str(), key.c_str());
-      fmap[key].second = true;
-    }
-    else if (fault_active && !faulty) {
-      ROS_WARN ("Resolved fault in %s: %s", component.c_str(), key.c_str());
-      fmap[key].second = false;
-    }
-  }
+  const string& component = faults.component();
+  const string fault_state = state_name + "Active";
+  bool was_faulted = faults.anyActive();
+  PublishBatch batch;
+  faults.update (msg_val, [&] (const string& fault, bool active) {
+      if (active) {
+        ROS_WARN ("Fault in %s: %s", component.c_str(), fault.c_str());
+      }
+      else {
+        ROS_WARN ("Resolved fault in %s: %s", component.c_str(), fault.c_str());
+      }
+      publish (fault_state, active, fault);
+    });
+  bool faulted = faults.anyActive();
+  if (faulted != was_faulted) publish (state_name, faulted);
 }
 
 void OwInterface::systemFaultMessageCallback
 (const  ow_faults::SystemFaults::ConstPtr& msg)
 {
-  faultCallback (msg->value, m_systemErrors, "SYSTEM");
+  faultCallback (msg->value, m_systemErrors, "SystemFault");
 }
 
 void OwInterface::armFaultCallback(const ow_faults::ArmFaults::ConstPtr& msg)
 {
-  faultCallback (msg->value, m_armErrors, "ARM");
+  faultCallback (msg->value, m_armErrors, "ArmFault");
 }
 
 void OwInterface::powerFaultCallback (const ow_faults::PowerFaults::ConstPtr& msg)
 {
-  faultCallback (msg->value, m_powerErrors, "POWER");
+  faultCallback (msg->value, m_powerErrors, "PowerFault");
 }
 
 void OwInterface::antennaFaultCallback(const ow_faults::PTFaults::ConstPtr& msg)
 {
-  faultCallback (msg->value, m_panTiltErrors, "ANTENNA");
+  faultCallback (msg->value, m_panTiltErrors, "AntennaFault");
 }
 
 void OwInterface::jointStatesCallback
 (const sensor_msgs::JointState::ConstPtr& msg)
 {
   // Publish all joint information for visibility to PLEXIL and handle any
-  // joint-related faults.
-
-  for (int i = 0; i < JointMap.size(); i++) {
-    string ros_name = msg->name[i];
-    if (JointMap.find (ros_name) != JointMap.end()) {
-      Joint joint = JointMap[ros_name];
-      double position = msg->position[i];
-      double velocity = msg->velocity[i];
-      double effort = msg->effort[i];
-      if (joint == Joint::antenna_pan) {
-        managePanTilt (Op_PanAntenna, position, velocity, m_currentPan,
-                       m_goalPan, m_panStart);
-      }
-      else if (joint == Joint::antenna_tilt) {
-        managePanTilt (Op_TiltAntenna, position, velocity, m_currentTilt,
-                       m_goalTilt, m_tiltStart);
-      }
-      JointTelemetryMap[joint] = JointTelemetry (position, velocity, effort);
-      string plexil_name = JointPropMap[joint].plexilName;
-      publish (plexil_name + "Position", position);
-      publish (plexil_name + "Velocity", velocity);
-      publish (plexil_name + "Effort", effort);
-      handle_joint_fault (joint, i, msg);
+  // joint-related faults.  Everything published here reaches the executive as
+  // one batch.
+
+  JointStates.decode (*msg, JointStateValues);
+  const JointStateBuffer& values = JointStateValues;
+
+  double now = ros::Time::now().toSec();
+  PublishBatch batch;
+  for (int j = 0; j < NumJoints; j++) {
+    Joint joint = static_cast<Joint>(j);
+    if (! values.has (joint)) continue;
+    uint32_t bit = 1u << j;
+    // Missing velocity or effort keeps the last known value.
+    JointTelemetry telemetry = Telemetry.joint (joint);
+    telemetry.position = values.position[j];
+    if (values.hasVelocity & bit) telemetry.velocity = values.velocity[j];
+    if (values.hasEffort & bit) telemetry.effort = values.effort[j];
+    // Antenna pointing is judged by where the joints actually are, which
+    // joint states always keep current.
+    if (joint == Joint::antenna_pan) {
+      double degrees = telemetry.position * R2D;
+      Telemetry.set (TelemetryChannel::PanDegrees, degrees);
+      publish ("PanDegrees", degrees);
+      managePanTilt (Op_PanAntenna, degrees);
+    }
+    else if (joint == Joint::antenna_tilt) {
+      double degrees = telemetry.position * R2D;
+      Telemetry.set (TelemetryChannel::TiltDegrees, degrees);
+      publish ("TiltDegrees", degrees);
+      managePanTilt (Op_TiltAntenna, degrees);
+    }
+    Telemetry.setJoint (joint, telemetry);
+    const JointProperties& props = jointProperties (joint);
+    publish (props.positionState, telemetry.position);
+    joint_history (joint, JointQuantity::Position).add (now, telemetry.position);
+    if (values.hasVelocity & bit) {
+      publish (props.velocityState, telemetry.velocity);
+      joint_history (joint, JointQuantity::Velocity).add (now,
+                                                          telemetry.velocity);
+    }
+    if (values.hasEffort & bit) {
+      publish (props.effortState, telemetry.effort);
+      joint_history (joint, JointQuantity::Effort).add (now, telemetry.effort);
+      handle_joint_fault (joint, telemetry.effort);
+    }
+  }
+
+  if (values.has (Joint::antenna_pan) && values.has (Joint::antenna_tilt)) {
+    JointTelemetry pan = Telemetry.joint (Joint::antenna_pan);
+    JointTelemetry tilt = Telemetry.joint (Joint::antenna_tilt);
+    managePointAntenna (pan, tilt);
+    if (Panorama) {
+      Panorama->antennaState (pan.position * R2D, tilt.position * R2D,
+                              pan.velocity * R2D, tilt.velocity * R2D);
     }
-    else ROS_ERROR("jointStatesCallback: unsupported joint %s",
-                   ros_name.c_str());
   }
 }
 
-void OwInterface::managePanTilt (const string& opname,
-                                 double position, double velocity,
-                                 double current, double goal,
-                                 const ros::Time& start)
+// The goal of each antenna operation, with the id of the command that set it.
+// A goal is set only once its command is running, so a command refused for a
+// conflict cannot disturb the goal of the operation it conflicts with.
+struct AntennaGoal
+{
+  int id;
+  double pan, tilt;   // degrees; a pan or tilt uses only its own axis
+};
+
+static map<string, AntennaGoal> AntennaGoals {
+  { Op_PanAntenna, { IDLE_ID, 0, 0 } },
+  { Op_TiltAntenna, { IDLE_ID, 0, 0 } },
+  { Op_PointAntenna, { IDLE_ID, 0, 0 } }
+};
+static std::mutex AntennaGoalMutex;
+
+static void set_antenna_goal (const string& opname, int id,
+                              double pan, double tilt)
+{
+  std::lock_guard<std::mutex> lock (AntennaGoalMutex);
+  AntennaGoals.at (opname) = { id, pan, tilt };
+}
+
+// False until the given command has set its goal.
+static bool antenna_goal (const string& opname, int id, AntennaGoal& goal)
+{
+  std::lock_guard<std::mutex> lock (AntennaGoalMutex);
+  goal = AntennaGoals.at (opname);
+  return goal.id == id;
+}
+
+void OwInterface::managePanTilt (const string& opname, double current)
 {
   // We are only concerned when there is a pan/tilt in progress.
   if (! operationRunning (opname)) return;
 
   int id = Running.at (opname);
+  AntennaGoal goal;
+  if (! antenna_goal (opname, id, goal)) return;
 
-  // Antenna states of interest,
-  bool reached = within_tolerance (current, goal, DegreeTolerance);
-  bool expired = ros::Time::now() > start + ros::Duration (PanTiltTimeout);
-
-  if (reached || expired) {
+  // A pan/tilt that never gets there is failed by the watchdog.
+  double target = opname == Op_PanAntenna ? goal.pan : goal.tilt;
+  if (within_tolerance (current, target, DegreeTolerance)) {
     mark_operation_finished (opname, id);
-    if (expired) ROS_ERROR("%s timed out", opname.c_str());
-    if (! reached) {
-      ROS_ERROR("%s failed. Ended at %f degrees, goal was %f.",
-                opname.c_str(), current, goal);
-    }
+  }
+}
+
+void OwInterface::managePointAntenna (const JointTelemetry& pan,
+                                      const JointTelemetry& tilt)
+{
+  if (! operationRunning (Op_PointAntenna)) return;
+
+  int id = Running.at (Op_PointAntenna);
+  AntennaGoal goal;
+  if (! antenna_goal (Op_PointAntenna, id, goal)) return;
+
+  // Done once both axes have arrived and stopped; a pointing that never gets
+  // there is failed by the watchdog.
+  auto settled = [] (const JointTelemetry& joint, double goal) {
+    return within_tolerance (joint.position * R2D, goal, DegreeTolerance) &&
+      fabs (joint.velocity) <= VelocityTolerance;
+  };
+  if (settled (pan, goal.pan) && settled (tilt, goal.tilt)) {
+    mark_operation_finished (Op_PointAntenna, id);
   }
 }
 
 
 ///////////////////////// Antenna/Camera Support ///////////////////////////////
 
-void OwInterface::panCallback
-(const control_msgs::JointControllerState::ConstPtr& msg)
+// The latest image, when images are retained (see retain_images in
+// OwInterface::initialize).  Shared with the subscription, not copied.
+static sensor_msgs::Image::ConstPtr LatestImage;
+static std::mutex LatestImageMutex;
+
+static void picture_taken ()
 {
-  m_currentPan = msg->set_point * R2D;
-  publish ("PanDegrees", m_currentPan);
+  int id = Running.at (Op_TakePicture);
+  if (id != IDLE_ID) mark_operation_finished (Op_TakePicture, id);
+  if (Panorama) Panorama->pictureTaken();
 }
 
-void OwInterface::tiltCallback
-(const control_msgs::JointControllerState::ConstPtr& msg)
+void OwInterface::cameraInfoCallback
+(const sensor_msgs::CameraInfo::ConstPtr& msg)
 {
-  m_currentTilt = msg->set_point * R2D;
-  publish ("TiltDegrees", m_currentTilt);
+  // The camera publishes its (small) calibration with every image, which
+  // is all we need to know the picture was taken.
+  picture_taken();
 }
 
 void OwInterface::cameraCallback (const sensor_msgs::Image::ConstPtr& msg)
 {
-  // NOTE: the received image is ignored for now.
+  std::lock_guard<std::mutex> lock (LatestImageMutex);
+  LatestImage = msg;
+}
 
-  if (operationRunning (Op_TakePicture)) {
-    mark_operation_finished (Op_TakePicture, Running.at (Op_TakePicture));
-  }
+sensor_msgs::Image::ConstPtr OwInterface::latestImage () const
+{
+  std::lock_guard<std::mutex> lock (LatestImageMutex);
+  return LatestImage;
 }
 
 
 ///////////////////////// Power support /////////////////////////////////////
 
-static double StateOfCharge       = NAN;
-static double RemainingUsefulLife = NAN;
-static double BatteryTemperature  = NAN;
-
 static void soc_callback (const std_msgs::Float64::ConstPtr& msg)
 {
-  StateOfCharge = msg->data;
-  publish ("StateOfCharge", StateOfCharge);
+  Telemetry.set (TelemetryChannel::StateOfCharge, msg->data);
+  power_history (PowerQuantity::StateOfCharge).add (ros::Time::now().toSec(),
+                                                    msg->data);
+  publish ("StateOfCharge", msg->data);
 }
 
 static void rul_callback (const std_msgs::Int16::ConstPtr& msg)
 {
   // NOTE: This is not being called as of 4/12/21.  Jira OW-656 addresses.
-  RemainingUsefulLife = msg->data;
-  publish ("RemainingUsefulLife", RemainingUsefulLife);
+  double rul = msg->data;
+  Telemetry.set (TelemetryChannel::RemainingUsefulLife, rul);
+  power_history (PowerQuantity::RemainingUsefulLife).add
+    (ros::Time::now().toSec(), rul);
+  publish ("RemainingUsefulLife", rul);
 }
 
 static void temperature_callback (const std_msgs::Float64::ConstPtr& msg)
 {
-  BatteryTemperature = msg->data;
-  publish ("BatteryTemperature", BatteryTemperature);
+  Telemetry.set (TelemetryChannel::BatteryTemperature, msg->data);
+  power_history (PowerQuantity::BatteryTemperature).add
+    (ros::Time::now().toSec(), msg->data);
+  publish ("BatteryTemperature", msg->data);
 }
 
 
@@ -364,46 +553,54 @@ static void temperature_callback (const std_msgs::Float64::ConstPtr& msg)
 // operation: it is not meaningful otherwise, and can be possibly misused given
 // the current plan interface.
 
-static bool GroundFound = false;
-static double GroundPosition = 0; // should not be queried unless GroundFound
-
 bool OwInterface::groundFound () const
 {
-  return GroundFound;
+  return Telemetry.ground().found;
 }
 
 double OwInterface::groundPosition () const
 {
-  return GroundPosition;
-}
-
-template <typename T>
-bool OwInterface::faultActive (const T& fmap) const
-{
-  for (auto const& entry : fmap) {
-    if (entry.second.second) return true;
-  }
-  return false;
+  return Telemetry.ground().position;
 }
 
 bool OwInterface::systemFault () const
 {
-  return faultActive (m_systemErrors);
+  return m_systemErrors.anyActive();
 }
 
 bool OwInterface::antennaFault () const
 {
-  return faultActive (m_panTiltErrors);
+  return m_panTiltErrors.anyActive();
 }
 
 bool OwInterface::armFault () const
 {
-  return faultActive (m_armErrors);
+  return m_armErrors.anyActive();
 }
 
 bool OwInterface::powerFault () const
 {
-  return faultActive (m_powerErrors);
+  return m_powerErrors.anyActive();
+}
+
+bool OwInterface::systemFaultActive (const string& fault_name) const
+{
+  return m_systemErrors.active (fault_name);
+}
+
+bool OwInterface::antennaFaultActive (const string& fault_name) const
+{
+  return m_panTiltErrors.active (fault_name);
+}
+
+bool OwInterface::armFaultActive (const string& fault_name) const
+{
+  return m_armErrors.active (fault_name);
+}
+
+bool OwInterface::powerFaultActive (const string& fault_name) const
+{
+  return m_powerErrors.active (fault_name);
 }
 
 template<int OpIndex, typename T>
@@ -412,15 +609,47 @@ static void guarded_move_done_cb
  const T& result)
 {
   ROS_INFO ("GuardedMove finished in state %s", state.toString().c_str());
-  GroundFound = result->success;
-  GroundPosition = result->final.z;
-  publish ("GroundFound", GroundFound);
-  publish ("GroundPosition", GroundPosition);
+  GroundContact ground;
+  ground.found = result->success;
+  ground.position = result->final.z;
+  Telemetry.setGround (ground);
+  PublishBatch batch;
+  publish ("GroundFound", ground.found);
+  publish ("GroundPosition", ground.position);
 }
 
 //////////////////// General Action support ///////////////////////////////
 
 const auto ActionServerTimeout = 10.0;  // seconds
+const auto ActionServerPollPeriod = 0.2;  // seconds
+
+// Action servers connect in the background after startup, all at once.  Until
+// a server is connected, goals for it are held.  Goals still held when the
+// connection window (ActionServerTimeout) closes fail, as do those arriving
+// later for a server that has not connected.
+
+struct HeldGoal
+{
+  int id;
+  ActionExecutor::Task send;
+};
+
+struct ActionServer
+{
+  std::function<bool()> connected;  // asks the action client
+  std::function<void()> cancel;     // cancels the client's goal
+  std::atomic<bool> ready { false };
+  std::vector<HeldGoal> held;
+  std::atomic<int> abortedId { IDLE_ID }; // last operation aborted
+};
+
+// Keyed by operation name; entries are added only during initialization.
+static map<string, ActionServer> ActionServers;
+
+// Guards held goals and the connection window.
+static std::mutex ActionServerMutex;
+static bool ConnectionWindowOpen = true;
+static std::chrono::steady_clock::time_point ConnectionStart;
 
 //////////////////// ROS Action callbacks - generic //////////////////////
 
@@ -460,22 +689,17 @@ OwInterface::OwInterface ()
     m_antennaTiltPublisher (nullptr),
     m_antennaPanPublisher (nullptr),
     m_leftImageTriggerPublisher (nullptr),
-    m_antennaTiltSubscriber (nullptr),
-    m_antennaPanSubscriber (nullptr),
     m_jointStatesSubscriber (nullptr),
-    m_cameraSubscriber (nullptr),
     m_socSubscriber (nullptr),
     m_rulSubscriber (nullptr),
     m_batteryTempSubscriber (nullptr),
     m_systemFaultMessagesSubscriber (nullptr),
     m_armFaultMessagesSubscriber (nullptr),
     m_powerFaultMessagesSubscriber (nullptr),
-    m_ptFaultMessagesSubscriber (nullptr),
-
-    m_currentPan (0), m_currentTilt (0),
-    m_goalPan (0), m_goalTilt (0)
-    // m_panStart, m_tiltStart are deliberately uninitialized
+    m_ptFaultMessagesSubscriber (nullptr)
 {
+  Telemetry.set (TelemetryChannel::PanDegrees, 0);
+  Telemetry.set (TelemetryChannel::TiltDegrees, 0);
 }
 
 OwInterface::~OwInterface ()
@@ -483,23 +707,64 @@ OwInterface::~OwInterface ()
   if (m_genericNodeHandle) delete m_genericNodeHandle;
   if (m_antennaTiltPublisher) delete m_antennaTiltPublisher;
   if (m_leftImageTriggerPublisher) delete m_leftImageTriggerPublisher;
-  if (m_antennaTiltSubscriber) delete m_antennaTiltSubscriber;
-  if (m_antennaPanSubscriber) delete m_antennaPanSubscriber;
   if (m_jointStatesSubscriber) delete m_jointStatesSubscriber;
-  if (m_cameraSubscriber) delete m_cameraSubscriber;
   if (m_socSubscriber) delete m_socSubscriber;
   if (m_rulSubscriber) delete m_rulSubscriber;
   if (m_batteryTempSubscriber) delete m_batteryTempSubscriber;
   if (m_instance) delete m_instance;
 }
 
-void OwInterface::initialize()
+static int positive_param (const ros::NodeHandle& nh, const string& param,
+                           int default_value)
+{
+  int value = nh.param (param, default_value);
+  if (value < 1) {
+    ROS_WARN ("Parameter %s must be at least 1, using %d.",
+              param.c_str(), default_value);
+    value = default_value;
+  }
+  return value;
+}
+
+void OwInterface::initialize (const ros::NodeHandle& private_nh)
 {
   static bool initialized = false;
 
   if (not initialized) {
     m_genericNodeHandle = new ros::NodeHandle();
 
+    // Node handles for each callback category.  Anything subscribed through
+    // one of these is serviced only by that category's spinner.
+
+    m_telemetryNodeHandle.reset (new ros::NodeHandle());
+    m_telemetryNodeHandle->setCallbackQueue (&m_telemetryQueue);
+    m_faultNodeHandle.reset (new ros::NodeHandle());
+    m_faultNodeHandle->setCallbackQueue (&m_faultQueue);
+    m_actionNodeHandle.reset (new ros::NodeHandle());
+    m_actionNodeHandle->setCallbackQueue (&m_actionQueue);
+
+    // Joint definitions must be in place before joint telemetry arrives.
+    loadJointTable (private_nh);
+
+    // Samples of history kept per telemetry value.
+    int history_size = positive_param (private_nh, "history_samples", 1000);
+    for (auto& joint : JointHistory) {
+      for (auto& history : joint) history.setCapacity (history_size);
+    }
+    for (auto& history : PowerHistory) history.setCapacity (history_size);
+
+    // Operation timeouts, seconds.
+    for (auto& timeout : OperationTimeouts) {
+      double seconds;
+      if (! private_nh.getParam ("timeouts/" + timeout.first, seconds)) continue;
+      if (seconds < 0) {
+        ROS_WARN ("Timeout of %s must not be negative, using %.1f.",
+                  timeout.first.c_str(), timeout.second.load());
+        continue;
+      }
+      timeout.second = seconds;
+    }
+
     // Initialize publishers.  Queue size is a guess at adequacy.  For now,
     // latching in lieu of waiting for publishers.
 
@@ -515,81 +780,156 @@ void OwInterface::initialize()
       (m_genericNodeHandle->advertise<std_msgs::Empty>
        ("/StereoCamera/left/image_trigger", qsize, latch));
 
-    // Initialize subscribers
+    createPanoramaEngine (private_nh);
+
+    // Initialize subscribers.  Those made on demand are set up here, but not
+    // subscribed until needed by an operation.
+
+    // A picture is known to be taken from the camera's info message, which is
+    // small, so it is always subscribed and never misses a picture.  Images
+    // are subscribed only if retained for other consumers, and then only
+    // while a picture is in flight, as their transfer and deserialization
+    // dominate everything else the node receives.  An image published before
+    // that subscription connects is not retained.
+    m_cameraInfoSubscriber.reset (new ros::Subscriber
+      (m_actionNodeHandle ->
+       subscribe("/StereoCamera/left/camera_info", qsize,
+                 &OwInterface::cameraInfoCallback, this)));
+    if (private_nh.param ("retain_images", false)) {
+      m_imageSubscription.reset (new LazySubscription
+        ("/StereoCamera/left/image_raw", [this] () {
+          return m_actionNodeHandle ->
+            subscribe("/StereoCamera/left/image_raw", qsize,
+                      &OwInterface::cameraCallback, this);
+        }));
+      OperationTopics[Op_TakePicture] = m_imageSubscription.get();
+      OperationTopics[Op_TakePanorama] = m_imageSubscription.get();
+    }
 
-    m_antennaTiltSubscriber = new ros::Subscriber
-      (m_genericNodeHandle ->
-       subscribe("/ant_tilt_position_controller/state", qsize,
-                 &OwInterface::tiltCallback, this));
-    m_antennaPanSubscriber = new ros::Subscriber
-      (m_genericNodeHandle ->
-       subscribe("/ant_pan_position_controller/state", qsize,
-                 &OwInterface::panCallback, this));
     m_jointStatesSubscriber = new ros::Subscriber
-      (m_genericNodeHandle ->
+      (m_telemetryNodeHandle ->
        subscribe("/joint_states", qsize,
                  &OwInterface::jointStatesCallback, this));
-    m_cameraSubscriber = new ros::Subscriber
-      (m_genericNodeHandle ->
-       subscribe("/StereoCamera/left/image_raw", qsize,
-                 &OwInterface::cameraCallback, this));
     m_socSubscriber = new ros::Subscriber
-      (m_genericNodeHandle ->
+      (m_telemetryNodeHandle ->
        subscribe("/power_system_node/state_of_charge", qsize, soc_callback));
     m_batteryTempSubscriber = new ros::Subscriber
-      (m_genericNodeHandle ->
+      (m_telemetryNodeHandle ->
        subscribe("/power_system_node/battery_temperature", qsize,
                  temperature_callback));
     m_rulSubscriber = new ros::Subscriber
-      (m_genericNodeHandle ->
+      (m_telemetryNodeHandle ->
        subscribe("/power_system_node/remaining_useful_life", qsize, rul_callback));
     // subscribers for fault messages
     m_systemFaultMessagesSubscriber.reset(new ros::Subscriber
-      (m_genericNodeHandle ->
+      (m_faultNodeHandle ->
        subscribe("/faults/system_faults_status", qsize,
                 &OwInterface::systemFaultMessageCallback, this)));
     m_armFaultMessagesSubscriber.reset(new ros::Subscriber
-      (m_genericNodeHandle ->
+      (m_faultNodeHandle ->
        subscribe("/faults/arm_faults_status", qsize,
                 &OwInterface::armFaultCallback, this)));
     m_powerFaultMessagesSubscriber.reset(new ros::Subscriber
-      (m_genericNodeHandle ->
+      (m_faultNodeHandle ->
        subscribe("/faults/power_faults_status", qsize,
                 &OwInterface::powerFaultCallback, this)));
     m_ptFaultMessagesSubscriber.reset(new ros::Subscriber
-      (m_genericNodeHandle ->
+      (m_faultNodeHandle ->
        subscribe("/faults/pt_faults_status", qsize,
                 &OwInterface::antennaFaultCallback, this)));
 
-    m_guardedMoveClient.reset(new GuardedMoveActionClient(Op_GuardedMove, true));
-    m_unstowClient.reset(new UnstowActionClient(Op_Unstow, true));
-    m_stowClient.reset(new StowActionClient(Op_Stow, true));
-    m_grindClient.reset(new GrindActionClient(Op_Grind, true));
-    m_digCircularClient.reset(new DigCircularActionClient(Op_DigCircular, true));
-    m_digLinearClient.reset(new DigLinearActionClient(Op_DigLinear, true));
-    m_deliverClient.reset(new DeliverActionClient(Op_Deliver, true));
-
-    if (! m_unstowClient->waitForServer(ros::Duration(ActionServerTimeout))) {
-      ROS_ERROR ("Unstow action server did not connect!");
-    }
-    if (! m_stowClient->waitForServer(ros::Duration(ActionServerTimeout))) {
-      ROS_ERROR ("Stow action server did not connect!");
-    }
-    if (! m_digCircularClient->waitForServer(ros::Duration(ActionServerTimeout))) {
-      ROS_ERROR ("DigCircular action server did not connect!");
-    }
-    if (! m_digLinearClient->waitForServer(ros::Duration(ActionServerTimeout))) {
-      ROS_ERROR ("DigLinear action server did not connect!");
-    }
-    if (! m_deliverClient->waitForServer(ros::Duration(ActionServerTimeout))) {
-      ROS_ERROR ("Deliver action server did not connect!");
-    }
-    if (! m_guardedMoveClient->waitForServer(ros::Duration(ActionServerTimeout))) {
-      ROS_ERROR ("GuardedMove action server did not connect!");
-    }
+    // Action clients share the action callback queue rather than each
+    // spinning a thread of their own.
+    const bool spin_thread = false;
+    m_guardedMoveClient.reset
+      (new GuardedMoveActionClient (*m_actionNodeHandle, Op_GuardedMove,
+                                    spin_thread));
+    m_unstowClient.reset
+      (new UnstowActionClient (*m_actionNodeHandle, Op_Unstow, spin_thread));
+    m_stowClient.reset
+      (new StowActionClient (*m_actionNodeHandle, Op_Stow, spin_thread));
+    m_grindClient.reset
+      (new GrindActionClient (*m_actionNodeHandle, Op_Grind, spin_thread));
+    m_digCircularClient.reset
+      (new DigCircularActionClient (*m_actionNodeHandle, Op_DigCircular,
+                                    spin_thread));
+    m_digLinearClient.reset
+      (new DigLinearActionClient (*m_actionNodeHandle, Op_DigLinear,
+                                  spin_thread));
+    m_deliverClient.reset
+      (new DeliverActionClient (*m_actionNodeHandle, Op_Deliver, spin_thread));
+
+    // Start the spinners.  Callbacks of a given subscription are never run
+    // concurrently with themselves, so extra threads only add parallelism
+    // across topics within a category.  Thread counts are private parameters
+    // of the node.
+
+    int telemetry_threads = positive_param (private_nh, "telemetry_threads", 1);
+    int fault_threads = positive_param (private_nh, "fault_threads", 1);
+    int action_threads = positive_param (private_nh, "action_threads", 1);
+    m_telemetrySpinner.reset
+      (new ros::AsyncSpinner (telemetry_threads, &m_telemetryQueue));
+    m_faultSpinner.reset (new ros::AsyncSpinner (fault_threads, &m_faultQueue));
+    m_actionSpinner.reset
+      (new ros::AsyncSpinner (action_threads, &m_actionQueue));
+    m_telemetrySpinner->start();
+    m_faultSpinner->start();
+    m_actionSpinner->start();
+
+    // Lander operations are started, and their completions processed, on a
+    // fixed pool of threads.
+    m_executor.reset
+      (new ActionExecutor (positive_param (private_nh, "executor_threads", 2),
+                           positive_param (private_nh, "executor_queue_size",
+                                           32)));
+
+    // Watch the action servers connect, rather than waiting on each in turn.
+    // The check runs on the action spinner, which also services the clients'
+    // connection callbacks.
+
+    watchActionServer (Op_Unstow, m_unstowClient);
+    watchActionServer (Op_Stow, m_stowClient);
+    watchActionServer (Op_Grind, m_grindClient);
+    watchActionServer (Op_DigCircular, m_digCircularClient);
+    watchActionServer (Op_DigLinear, m_digLinearClient);
+    watchActionServer (Op_Deliver, m_deliverClient);
+    watchActionServer (Op_GuardedMove, m_guardedMoveClient);
+    ConnectionStart = std::chrono::steady_clock::now();
+    m_connectionTimer = m_actionNodeHandle->createSteadyTimer
+      (ros::WallDuration (ActionServerPollPeriod),
+       &OwInterface::monitorActionServers, this);
+
+    // Operation deadlines are in ROS time, so that they scale with the
+    // simulation.
+    m_watchdogTimer = m_actionNodeHandle->createTimer
+      (ros::Duration (WatchdogTick), &OwInterface::advanceWatchdog, this);
+    initialized = true;
   }
 }
 
+void OwInterface::advanceWatchdog (const ros::TimerEvent&)
+{
+  Watchdog.advance (ros::Time::now().toSec());
+}
+
+bool OwInterface::setOperationTimeout (const string& opname, double seconds)
+{
+  auto entry = OperationTimeouts.find (opname);
+  if (entry == OperationTimeouts.end() || seconds < 0) return false;
+  // Applies from the next start of the operation.
+  entry->second = seconds;
+  return true;
+}
+
+double OwInterface::operationTimeout (const string& opname) const
+{
+  auto entry = OperationTimeouts.find (opname);
+  if (entry != OperationTimeouts.end()) return entry->second;
+  ROS_ERROR ("OwInterface::operationTimeout: unsupported operation: %s",
+             opname.c_str());
+  return 0;
+}
+
 void OwInterface::setCommandStatusCallback (void (*callback) (int, bool))
 {
   CommandStatusCallback = callback;
@@ -601,45 +941,371 @@ static void antenna_op (const string& opname, double degrees,
   if (! mark_operation_running (opname, id)) {
     return;
   }
+  set_antenna_goal (opname, id, degrees, degrees);
 
   std_msgs::Float64 radians;
   radians.data = degrees * D2R;
   ROS_INFO ("Starting %s: %f degrees (%f radians)", opname.c_str(),
             degrees, radians.data);
-  thread fault_thread (monitor_for_faults, opname);
-  fault_thread.detach();
   pub->publish (radians);
 }
 
 void OwInterface::tiltAntenna (double degrees, int id)
 {
-  m_goalTilt = degrees;
-  m_tiltStart = ros::Time::now();
   antenna_op (Op_TiltAntenna, degrees, m_antennaTiltPublisher, id);
 }
 
 void OwInterface::panAntenna (double degrees, int id)
 {
-  m_goalPan = degrees;
-  m_panStart = ros::Time::now();
   antenna_op (Op_PanAntenna, degrees, m_antennaPanPublisher, id);
 }
 
-void OwInterface::takePicture (int id)
+void OwInterface::pointAntenna (double pan_degrees, double tilt_degrees,
+                                int id)
+{
+  if (! mark_operation_running (Op_PointAntenna, id)) return;
+  set_antenna_goal (Op_PointAntenna, id, pan_degrees, tilt_degrees);
+
+  // Both axes are commanded at once: their controllers are independent.
+  ROS_INFO ("Starting %s: pan %f, tilt %f degrees", Op_PointAntenna.c_str(),
+            pan_degrees, tilt_degrees);
+  std_msgs::Float64 radians;
+  radians.data = pan_degrees * D2R;
+  m_antennaPanPublisher->publish (radians);
+  radians.data = tilt_degrees * D2R;
+  m_antennaTiltPublisher->publish (radians);
+}
+
+static void trigger_camera (ros::Publisher* trigger)
 {
-  if (! mark_operation_running (Op_TakePicture, id)) return;
   std_msgs::Empty msg;
   ROS_INFO ("Capturing stereo image using left image trigger.");
-  thread fault_thread (monitor_for_faults, Op_TakePicture);
-  fault_thread.detach();
-  m_leftImageTriggerPublisher->publish (msg);
+  trigger->publish (msg);
+}
+
+void OwInterface::takePicture (int id)
+{
+  if (! mark_operation_running (Op_TakePicture, id)) return;
+  trigger_camera (m_leftImageTriggerPublisher);
+}
+
+// Order in which panorama tiles are taken (see tile_scheduler.h).
+static std::atomic<TileOrdering> PanoramaOrdering (TileOrdering::MinimumSlew);
+
+void OwInterface::takePanorama (double tilt_lo, double tilt_hi,
+                                double pan_lo, double pan_hi,
+                                double vert_overlap, double horiz_overlap,
+                                const string& completed, int id)
+{
+  PanoramaSpec spec { tilt_lo, tilt_hi, pan_lo, pan_hi,
+                      vert_overlap, horiz_overlap };
+  string error;
+  if (! validPanorama (spec, error)) {
+    ROS_ERROR ("TakePanorama: %s.", error.c_str());
+    CommandStatusCallback (id, false);
+    return;
+  }
+  std::vector<PanoramaTile> grid = panoramaGrid (spec);
+
+  // A panorama resumed (e.g. after a crash) skips the tiles already taken.
+  string done (grid.size(), '0');
+  if (validTileMask (completed, grid.size())) done = completed;
+  else if (! completed.empty()) {
+    ROS_WARN ("TakePanorama: completed tiles '%s' don't fit a grid of %zu, "
+              "taking all tiles.", completed.c_str(), grid.size());
+  }
+  if (done.find ('0') == string::npos) {
+    ROS_INFO ("TakePanorama: all %zu tiles already taken.", grid.size());
+    CommandStatusCallback (id, true);
+    return;
+  }
+
+  if (! mark_operation_running (Op_TakePanorama, id)) return;
+  TileOrdering ordering = PanoramaOrdering;
+  for (TileOrdering o : { TileOrdering::Serpentine, TileOrdering::RowMajor,
+                          TileOrdering::MinimumSlew }) {
+    double estimate;
+    std::vector<PanoramaTile> tiles = Panorama->plan (grid, done, o, estimate);
+    ROS_INFO ("Panorama of %zu tiles, %s order: estimated %.1f seconds%s.",
+              tiles.size(), tileOrderingName (o), estimate,
+              o == ordering ? " (chosen)" : "");
+  }
+  if (! Panorama->start (grid, done, ordering)) {
+    ROS_ERROR ("TakePanorama: the panorama engine could not start.");
+    mark_operation_finished (Op_TakePanorama, id, false);
+  }
+}
+
+void OwInterface::createPanoramaEngine (const ros::NodeHandle& private_nh)
+{
+  // The slew model's starting point, refined as the antenna moves.
+  auto rate = [&] (const string& param, double default_value) {
+    double value = private_nh.param (param, default_value);
+    if (value > 0) return value;
+    ROS_WARN ("Parameter %s must be positive, using %.1f.",
+              param.c_str(), default_value);
+    return default_value;
+  };
+  SlewModel model;
+  model.panRate = rate ("panorama/pan_rate", 15.0);
+  model.tiltRate = rate ("panorama/tilt_rate", 15.0);
+  model.settleTime = private_nh.param ("panorama/settle_time", 0.5);
+  model.captureTime = private_nh.param ("panorama/capture_time", 1.0);
+
+  string ordering;
+  if (private_nh.getParam ("panorama/ordering", ordering) &&
+      ! setPanoramaOrdering (ordering)) {
+    ROS_WARN ("Unknown panorama ordering %s, using %s.", ordering.c_str(),
+              tileOrderingName (PanoramaOrdering));
+  }
+
+  // Both axes are commanded at once: their controllers are independent.
+  PanoramaEngine::Hooks hooks;
+  hooks.point = [this] (double pan, double tilt) {
+    std_msgs::Float64 radians;
+    radians.data = pan * D2R;
+    m_antennaPanPublisher->publish (radians);
+    radians.data = tilt * D2R;
+    m_antennaTiltPublisher->publish (radians);
+  };
+  hooks.capture = [this] () { trigger_camera (m_leftImageTriggerPublisher); };
+  hooks.progress = [] (PanoramaState state, int taken, int total,
+                       const string& done) {
+    PublishBatch batch;
+    publish ("PanoramaState", string (panoramaStateName (state)));
+    publish ("PanoramaTilesTaken", (double) taken);
+    publish ("PanoramaTiles", (double) total);
+    publish ("PanoramaTilesDone", done);
+  };
+  hooks.finished = [] (double estimated, double actual) {
+    SlewModel learned = Panorama->model();
+    ROS_INFO ("Panorama complete in %.1f seconds, estimated %.1f.  "
+              "Slew rates now pan %.1f, tilt %.1f degrees/s, settle %.2f s, "
+              "capture %.2f s.", actual, estimated, learned.panRate,
+              learned.tiltRate, learned.settleTime, learned.captureTime);
+    int id = Running.at (Op_TakePanorama);
+    if (id != IDLE_ID) mark_operation_finished (Op_TakePanorama, id);
+  };
+  hooks.now = [] () { return ros::Time::now().toSec(); };
+  Panorama.reset (new PanoramaEngine (hooks, model, DegreeTolerance,
+                                      VelocityTolerance * R2D));
+}
+
+bool OwInterface::setPanoramaOrdering (const string& name)
+{
+  TileOrdering ordering;
+  if (! parseTileOrdering (name, ordering)) return false;
+  PanoramaOrdering = ordering;
+  return true;
+}
+
+string OwInterface::panoramaOrdering () const
+{
+  return tileOrderingName (PanoramaOrdering);
+}
+
+string OwInterface::panoramaState () const
+{
+  return Panorama ? panoramaStateName (Panorama->state()) : "Idle";
+}
+
+double OwInterface::panoramaTilesTaken () const
+{
+  return Panorama ? Panorama->tilesTaken() : 0;
+}
+
+double OwInterface::panoramaTiles () const
+{
+  return Panorama ? Panorama->tileCount() : 0;
+}
+
+string OwInterface::panoramaTilesDone () const
+{
+  return Panorama ? Panorama->tilesDone() : "";
+}
+
+double OwInterface::panoramaEstimatedDuration () const
+{
+  return Panorama ? Panorama->estimatedDuration() : 0;
+}
+
+double OwInterface::panoramaDuration () const
+{
+  return Panorama ? Panorama->duration() : 0;
 }
 
 void OwInterface::deliver (double x, double y, double z, int id)
 {
   if (! mark_operation_running (Op_Deliver, id)) return;
-  thread action_thread (&OwInterface::deliverAction, this, x, y, z, id);
-  action_thread.detach();
+  startAction (Op_Deliver, id, [=] { deliverAction (x, y, z, id); });
+}
+
+template <class ActionClient>
+void OwInterface::watchActionServer (const string& opname,
+                                     std::unique_ptr<ActionClient>& ac)
+{
+  ActionClient* client = ac.get();
+  ActionServer& server = ActionServers[opname];
+  server.connected = [client] () { return client->isServerConnected(); };
+  server.cancel = [client] () { client->cancelGoal(); };
+}
+
+static bool action_aborted (const string& opname, int id)
+{
+  auto entry = ActionServers.find (opname);
+  return entry != ActionServers.end() && entry->second.abortedId == id;
+}
+
+bool OwInterface::abortOperation (int id)
+{
+  string opname;
+  for (const auto& op : Running) {
+    if (op.second == id) {
+      opname = op.first;
+      break;
+    }
+  }
+  if (opname.empty()) {
+    ROS_WARN ("No operation running for command %d, nothing to abort.", id);
+    return false;
+  }
+  ROS_INFO ("Aborting %s.", opname.c_str());
+
+  // The antenna is stopped by commanding it to stay where it is, once a
+  // panorama can no longer move it.
+  if (opname == Op_TakePanorama) Panorama->stop();
+  bool pan = opname == Op_PanAntenna || opname == Op_PointAntenna ||
+    opname == Op_TakePanorama;
+  bool tilt = opname == Op_TiltAntenna || opname == Op_PointAntenna ||
+    opname == Op_TakePanorama;
+  auto hold = [] (Joint joint, ros::Publisher* pub) {
+    std_msgs::Float64 radians;
+    radians.data = Telemetry.joint (joint).position;
+    pub->publish (radians);
+  };
+  if (pan) hold (Joint::antenna_pan, m_antennaPanPublisher);
+  if (tilt) hold (Joint::antenna_tilt, m_antennaTiltPublisher);
+  if (pan || tilt) {
+    mark_operation_finished (opname, id, false);
+    return true;
+  }
+
+  auto entry = ActionServers.find (opname);
+  if (entry == ActionServers.end()) {
+    // Nothing to stop, e.g. a picture: just stop waiting for it.
+    mark_operation_finished (opname, id, false);
+    return true;
+  }
+
+  // An action's goal may be held for its server, queued on the executor, or
+  // sent.  runAction checks abortedId before and after sending the goal.
+  ActionServer& server = entry->second;
+  server.abortedId = id;
+  bool was_held = false;
+  {
+    std::lock_guard<std::mutex> lock (ActionServerMutex);
+    for (auto goal = server.held.begin(); goal != server.held.end(); ++goal) {
+      if (goal->id == id) {
+        server.held.erase (goal);
+        was_held = true;
+        break;
+      }
+    }
+  }
+  if (was_held) mark_operation_finished (opname, id, false);
+  else server.cancel();
+  return true;
+}
+
+void OwInterface::monitorActionServers (const ros::SteadyTimerEvent&)
+{
+  bool all_ready = true;
+  for (auto& entry : ActionServers) {
+    const string& opname = entry.first;
+    ActionServer& server = entry.second;
+    if (server.ready) continue;
+    if (! server.connected()) {
+      all_ready = false;
+      continue;
+    }
+    std::vector<HeldGoal> held;
+    {
+      std::lock_guard<std::mutex> lock (ActionServerMutex);
+      server.ready = true;
+      held.swap (server.held);
+    }
+    ROS_INFO ("%s action server connected.", opname.c_str());
+    publish ("ActionServerReady", true, opname);
+    for (auto& goal : held) dispatchAction (opname, goal.id, goal.send);
+  }
+
+  if (all_ready) {
+    m_connectionTimer.stop();
+    return;
+  }
+
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - ConnectionStart;
+  if (elapsed.count() < ActionServerTimeout) return;
+
+  // The connection window has closed; keep watching for late connections,
+  // but stop holding goals.
+  std::vector<std::pair<string, HeldGoal>> failed;
+  {
+    std::lock_guard<std::mutex> lock (ActionServerMutex);
+    if (! ConnectionWindowOpen) return;
+    ConnectionWindowOpen = false;
+    for (auto& entry : ActionServers) {
+      if (entry.second.ready) continue;
+      ROS_ERROR ("%s action server did not connect!", entry.first.c_str());
+      for (auto& goal : entry.second.held) {
+        failed.emplace_back (entry.first, goal);
+      }
+      entry.second.held.clear();
+    }
+  }
+  for (auto& goal : failed) {
+    mark_operation_finished (goal.first, goal.second.id, false);
+  }
+}
+
+bool OwInterface::actionServerReady (const string& opname) const
+{
+  auto entry = ActionServers.find (opname);
+  return entry != ActionServers.end() && entry->second.ready;
+}
+
+void OwInterface::startAction (const string& opname, int id,
+                               ActionExecutor::Task send_goal)
+{
+  ActionServer& server = ActionServers.at (opname);
+  if (! server.ready) {
+    std::unique_lock<std::mutex> lock (ActionServerMutex);
+    if (! server.ready) {
+      if (ConnectionWindowOpen) {
+        ROS_INFO ("%s action server not yet connected, holding goal.",
+                  opname.c_str());
+        server.held.push_back ({ id, send_goal });
+        return;
+      }
+      lock.unlock();
+      ROS_ERROR ("%s action server not connected, command failed.",
+                 opname.c_str());
+      mark_operation_finished (opname, id, false);
+      return;
+    }
+  }
+  dispatchAction (opname, id, send_goal);
+}
+
+void OwInterface::dispatchAction (const string& opname, int id,
+                                  ActionExecutor::Task send_goal)
+{
+  if (! m_executor || ! m_executor->post (send_goal)) {
+    ROS_ERROR ("%s rejected: action executor unavailable or queue full.",
+               opname.c_str());
+    mark_operation_finished (opname, id, false);
+  }
 }
 
 template <int OpIndex, class ActionClient, class Goal,
@@ -649,23 +1315,41 @@ void OwInterface::runAction (const string& opname,
                              const Goal& goal, int id,
                              t_action_done_cb<OpIndex, ResultPtr> done_cb)
 {
-  thread fault_thread (monitor_for_faults, opname);
-  if (ac) {
-    ROS_INFO ("Sending goal to action %s", opname.c_str());
-    ac->sendGoal (goal,
-                  done_cb,
-                  active_cb<OpIndex>,
-                  action_feedback_cb<FeedbackPtr>);
-  }
-  else {
+  if (! ac) {
     ROS_ERROR ("%s action client was null!", opname.c_str());
+    mark_operation_finished (opname, id, false);
     return;
   }
+  if (action_aborted (opname, id)) {
+    ROS_INFO ("%s aborted before its goal was sent.", opname.c_str());
+    mark_operation_finished (opname, id, false);
+    return;
+  }
+
+  // No thread waits for the action.  Its completion callback, which runs on
+  // the action spinner, hands the rest of the work to the executor.
 
-  // Wait indefinitely for the action to complete.
-  bool finished_before_timeout = ac->waitForResult (ros::Duration (0));
-  mark_operation_finished (opname, id);
-  fault_thread.join();
+  ActionExecutor* executor = m_executor.get();
+  auto on_done =
+    [executor, opname, id, done_cb]
+    (const actionlib::SimpleClientGoalState& state, const ResultPtr& result) {
+      executor->postOrRun ([opname, id, done_cb, state, result] {
+          done_cb (state, result);
+          mark_operation_finished
+            (opname, id,
+             state == actionlib::SimpleClientGoalState::SUCCEEDED);
+        });
+    };
+
+  ROS_INFO ("Sending goal to action %s", opname.c_str());
+  ac->sendGoal (goal,
+                on_done,
+                active_cb<OpIndex>,
+                action_feedback_cb<FeedbackPtr>);
+
+  // An abort arriving while the goal was being sent may have found nothing
+  // to cancel.
+  if (action_aborted (opname, id)) ac->cancelGoal();
 }
 
 void OwInterface::deliverAction (double x, double y, double z, int id)
@@ -686,9 +1370,9 @@ void OwInterface::digLinear (double x, double y,
                              int id)
 {
   if (! mark_operation_running (Op_DigLinear, id)) return;
-  thread action_thread (&OwInterface::digLinearAction, this, x, y, depth,
-                        length, ground_pos, id);
-  action_thread.detach();
+  startAction (Op_DigLinear, id, [=] {
+      digLinearAction (x, y, depth, length, ground_pos, id);
+    });
 }
 
 
@@ -715,9 +1399,9 @@ void OwInterface::digCircular (double x, double y, double depth,
                                double ground_pos, bool parallel, int id)
 {
   if (! mark_operation_running (Op_DigCircular, id)) return;
-  thread action_thread (&OwInterface::digCircularAction, this, x, y, depth,
-                        ground_pos, parallel, id);
-  action_thread.detach();
+  startAction (Op_DigCircular, id, [=] {
+      digCircularAction (x, y, depth, ground_pos, parallel, id);
+    });
 }
 
 void OwInterface::digCircularAction (double x, double y, double depth,
@@ -742,8 +1426,7 @@ void OwInterface::digCircularAction (double x, double y, double depth,
 void OwInterface::unstow (int id)  // as action
 {
   if (! mark_operation_running (Op_Unstow, id)) return;
-  thread action_thread (&OwInterface::unstowAction, this, id);
-  action_thread.detach();
+  startAction (Op_Unstow, id, [=] { unstowAction (id); });
 }
 
 void OwInterface::unstowAction (int id)
@@ -761,8 +1444,7 @@ void OwInterface::unstowAction (int id)
 void OwInterface::stow (int id)  // as action
 {
   if (! mark_operation_running (Op_Stow, id)) return;
-  thread action_thread (&OwInterface::stowAction, this, id);
-  action_thread.detach();
+  startAction (Op_Stow, id, [=] { stowAction (id); });
 }
 
 void OwInterface::stowAction (int id)
@@ -781,9 +1463,9 @@ void OwInterface::grind (double x, double y, double depth, double length,
                          bool parallel, double ground_pos, int id)
 {
   if (! mark_operation_running (Op_Grind, id)) return;
-  thread action_thread (&OwInterface::grindAction, this, x, y, depth, length,
-                        parallel, ground_pos, id);
-  action_thread.detach();
+  startAction (Op_Grind, id, [=] {
+      grindAction (x, y, depth, length, parallel, ground_pos, id);
+    });
 }
 
 void OwInterface::grindAction (double x, double y, double depth, double length,
@@ -809,9 +1491,9 @@ void OwInterface::guardedMove (double x, double y, double z,
                                double search_dist, int id)
 {
   if (! mark_operation_running (Op_GuardedMove, id)) return;
-  thread action_thread (&OwInterface::guardedMoveAction, this, x, y, z,
-                        dir_x, dir_y, dir_z, search_dist, id);
-  action_thread.detach();
+  startAction (Op_GuardedMove, id, [=] {
+      guardedMoveAction (x, y, z, dir_x, dir_y, dir_z, search_dist, id);
+    });
 }
 
 void OwInterface::guardedMoveAction (double x, double y, double z,
@@ -837,37 +1519,47 @@ void OwInterface::guardedMoveAction (double x, double y, double z,
 
 double OwInterface::getTilt () const
 {
-  return m_currentTilt;
+  return Telemetry.get (TelemetryChannel::TiltDegrees);
 }
 
 double OwInterface::getPanDegrees () const
 {
-  return m_currentPan;
+  return Telemetry.get (TelemetryChannel::PanDegrees);
 }
 
 double OwInterface::getPanVelocity () const
 {
-  return JointTelemetryMap[Joint::antenna_pan].velocity;
+  return Telemetry.joint (Joint::antenna_pan).velocity;
 }
 
 double OwInterface::getTiltVelocity () const
 {
-  return JointTelemetryMap[Joint::antenna_tilt].velocity;
+  return Telemetry.joint (Joint::antenna_tilt).velocity;
 }
 
 double OwInterface::getStateOfCharge () const
 {
-  return StateOfCharge;
+  return Telemetry.get (TelemetryChannel::StateOfCharge);
 }
 
 double OwInterface::getRemainingUsefulLife () const
 {
-  return RemainingUsefulLife;
+  return Telemetry.get (TelemetryChannel::RemainingUsefulLife);
 }
 
 double OwInterface::getBatteryTemperature () const
 {
-  return BatteryTemperature;
+  return Telemetry.get (TelemetryChannel::BatteryTemperature);
+}
+
+int OwInterface::actionQueueDepth () const
+{
+  return m_executor ? m_executor->queueDepth() : 0;
+}
+
+int OwInterface::actionThreadCount () const
+{
+  return m_executor ? m_executor->threadCount() : 0;
 }
 
 bool OwInterface::operationRunning (const string& name) const
@@ -884,14 +1576,50 @@ bool OwInterface::running (const string& name) const
   return false;
 }
 
+static bool torque_limit_reached (const string& joint_name, TorqueLimit limit)
+{
+  Joint joint;
+  if (! plexilNameToJoint (joint_name, joint)) {
+    ROS_ERROR ("Torque limit query for unknown joint %s", joint_name.c_str());
+    return false;
+  }
+  return TorqueLimits.reached (joint, limit);
+}
+
 bool OwInterface::hardTorqueLimitReached (const std::string& joint_name) const
 {
-  return (JointsAtHardTorqueLimit.find (joint_name) !=
-          JointsAtHardTorqueLimit.end());
+  return torque_limit_reached (joint_name, TorqueLimit::Hard);
 }
 
 bool OwInterface::softTorqueLimitReached (const std::string& joint_name) const
 {
-  return (JointsAtSoftTorqueLimit.find (joint_name) !=
-          JointsAtSoftTorqueLimit.end());
+  return torque_limit_reached (joint_name, TorqueLimit::Soft);
+}
+
+double OwInterface::jointStatistic (const string& joint_name,
+                                    JointQuantity quantity,
+                                    Statistic stat, double window) const
+{
+  Joint joint;
+  if (! plexilNameToJoint (joint_name, joint)) {
+    ROS_ERROR ("Telemetry statistic for unknown joint %s", joint_name.c_str());
+    return NAN;
+  }
+  double result;
+  if (! joint_history (joint, quantity).statistic
+      (stat, ros::Time::now().toSec(), window, result)) {
+    return NAN;
+  }
+  return result;
+}
+
+double OwInterface::powerStatistic (PowerQuantity quantity,
+                                    Statistic stat, double window) const
+{
+  double result;
+  if (! power_history (quantity).statistic
+      (stat, ros::Time::now().toSec(), window, result)) {
+    return NAN;
+  }
+  return result;
 }
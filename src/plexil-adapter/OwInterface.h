@@ -10,6 +10,8 @@
 // executive per lander.
 
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <ros/spinner.h>
 
 // ROS Actions
 #include <actionlib/client/simple_action_client.h>
@@ -21,12 +23,18 @@
 #include <ow_lander/DigLinearAction.h>
 #include <ow_lander/DeliverAction.h>
 
-#include <control_msgs/JointControllerState.h>
 #include <sensor_msgs/JointState.h>
 #include <sensor_msgs/Image.h>
+#include <sensor_msgs/CameraInfo.h>
 #include <geometry_msgs/Point.h>
 #include <string>
 
+#include "telemetry_store.h"
+#include "fault_support.h"
+#include "action_executor.h"
+#include "telemetry_history.h"
+#include "lazy_subscription.h"
+
 #include <ow_faults/SystemFaults.h>
 #include <ow_faults/ArmFaults.h>
 #include <ow_faults/PowerFaults.h>
@@ -56,10 +64,6 @@ void default_action_done_cb
 (const actionlib::SimpleClientGoalState& state,
  const T& result_ignored);
 
-// Maps from fault name to the pair (fault value, is fault in progress?)
-using FaultMap32 = std::map<std::string,std::pair<uint32_t, bool>>;
-using FaultMap64 = std::map<std::string,std::pair<uint64_t, bool>>;
-
 class OwInterface
 {
  public:
@@ -68,7 +72,9 @@ class OwInterface
   ~OwInterface ();
   OwInterface (const OwInterface&) = delete;
   OwInterface& operator= (const OwInterface&) = delete;
-  void initialize ();
+  // Configuration is read from the given node handle's namespace, normally
+  // the node's private one (or the nodelet's).
+  void initialize (const ros::NodeHandle& private_nh);
 
   // Operational interface
 
@@ -77,6 +83,8 @@ class OwInterface
                     double search_distance, int id);
   void tiltAntenna (double degrees, int id);
   void panAntenna (double degrees, int id);
+  // Pan and tilt at once, degrees; done once both axes have settled.
+  void pointAntenna (double pan_degrees, double tilt_degrees, int id);
   void takePicture (int id);
   void digLinear (double x, double y, double depth, double length,
                   double ground_pos, int id);
@@ -87,8 +95,33 @@ class OwInterface
   void stow (int id);
   void unstow (int id);
   void deliver (double x, double y, double z, int id);
-  void takePanorama (double elev_lo, double elev_hi,
-                     double lat_overlap, double vert_overlap);
+  // Take a panorama spanning the given tilts and pans, with the given overlap
+  // of adjacent images, all in degrees.  Tiles marked in completed (see
+  // validTileMask in panorama_engine.h) are skipped; it may be empty.
+  void takePanorama (double tilt_lo, double tilt_hi,
+                     double pan_lo, double pan_hi,
+                     double vert_overlap, double horiz_overlap,
+                     const std::string& completed, int id);
+
+  // Order in which panorama tiles are taken, by name (see tile_scheduler.h).
+  // Setting returns false for an unknown name.
+  bool setPanoramaOrdering (const std::string& name);
+  std::string panoramaOrdering () const;
+
+  // Progress of the panorama in progress, or of the last one: the engine's
+  // state (see panorama_engine.h), tiles taken, tiles in all, and which were
+  // taken.  Also its estimated and actual duration, seconds.
+  std::string panoramaState () const;
+  double panoramaTilesTaken () const;
+  double panoramaTiles () const;
+  std::string panoramaTilesDone () const;
+  double panoramaEstimatedDuration () const;
+  double panoramaDuration () const;
+
+  // Stop the operation started under the given id, which then finishes
+  // (unsuccessfully) as usual.  Returns false if no operation is running under
+  // the id.
+  bool abortOperation (int id);
 
   // State/Lookup interface
   double getTilt () const;
@@ -105,12 +138,42 @@ class OwInterface
   bool   armFault () const;
   bool   powerFault () const;
 
+  // Is the given fault of the category active?  Fault names are those of the
+  // fault tables below.
+  bool systemFaultActive (const std::string& fault_name) const;
+  bool antennaFaultActive (const std::string& fault_name) const;
+  bool armFaultActive (const std::string& fault_name) const;
+  bool powerFaultActive (const std::string& fault_name) const;
+
+  // Load on the executor running lander operations.
+  int actionQueueDepth () const;
+  int actionThreadCount () const;
+
+  // Is the action server for the given operation connected?
+  bool actionServerReady (const std::string& opname) const;
+
   // Is the given operation (as named in .cpp file) running?
   bool running (const std::string& name) const;
 
+  // Seconds an operation may run before it is stopped and fails; 0 for no
+  // limit.  Setting returns false for an unknown operation or negative time.
+  bool setOperationTimeout (const std::string& opname, double seconds);
+  double operationTimeout (const std::string& opname) const;
+
   bool hardTorqueLimitReached (const std::string& joint_name) const;
   bool softTorqueLimitReached (const std::string& joint_name) const;
 
+  // Statistics of recent telemetry over the trailing window, in seconds.  NAN
+  // if there are no samples in the window (or no such joint).
+  double jointStatistic (const std::string& joint_name, JointQuantity,
+                         Statistic, double window) const;
+  double powerStatistic (PowerQuantity, Statistic, double window) const;
+
+  // The last image received while a picture was in flight, shared rather
+  // than copied, if the node retains images (parameter retain_images);
+  // otherwise null.
+  sensor_msgs::Image::ConstPtr latestImage () const;
+
   // Command feedback
   void setCommandStatusCallback (void (*callback) (int, bool));
 
@@ -123,6 +186,15 @@ class OwInterface
                     const Goal&, int id,
                     t_action_done_cb<OpIndex, ResultPtr> done_cb =
                     default_action_done_cb<OpIndex, ResultPtr>);
+  void startAction (const std::string& opname, int id,
+                    ActionExecutor::Task send_goal);
+  void dispatchAction (const std::string& opname, int id,
+                       ActionExecutor::Task send_goal);
+  template <class ActionClient>
+    void watchActionServer (const std::string& opname,
+                            std::unique_ptr<ActionClient>&);
+  void monitorActionServers (const ros::SteadyTimerEvent&);
+  void advanceWatchdog (const ros::TimerEvent&);
   void unstowAction (int id);
   void stowAction (int id);
   void grindAction (double x, double y, double depth, double length,
@@ -137,66 +209,86 @@ class OwInterface
   void deliverAction (double x, double y, double z, int id);
   bool operationRunning (const std::string& name) const;
   void jointStatesCallback (const sensor_msgs::JointState::ConstPtr&);
-  void tiltCallback (const control_msgs::JointControllerState::ConstPtr&);
-  void panCallback (const control_msgs::JointControllerState::ConstPtr&);
   void cameraCallback (const sensor_msgs::Image::ConstPtr&);
-  void managePanTilt (const std::string& opname,
-                      double position, double velocity,
-                      double current, double goal,
-                      const ros::Time& start);
+  void cameraInfoCallback (const sensor_msgs::CameraInfo::ConstPtr&);
+  void createPanoramaEngine (const ros::NodeHandle& private_nh);
+  void managePanTilt (const std::string& opname, double current);
+  void managePointAntenna (const JointTelemetry& pan,
+                           const JointTelemetry& tilt);
   void systemFaultMessageCallback (const ow_faults::SystemFaults::ConstPtr&);
   void armFaultCallback (const ow_faults::ArmFaults::ConstPtr&);
   void powerFaultCallback (const ow_faults::PowerFaults::ConstPtr&);
   void antennaFaultCallback (const ow_faults::PTFaults::ConstPtr&);
 
-  template <typename T1, typename T2>
-    void faultCallback (T1 msg_val, T2&, const std::string& name);
+  // Decode a fault word, publishing each fault transition as
+  // <state_name>Active(fault) and any change of the category as <state_name>.
+  void faultCallback (uint64_t msg_val, FaultTable&,
+                      const std::string& state_name);
 
-  template <typename T>
-    bool faultActive (const T& fault_map) const;
+  // Faults, by name and value (see fault_support.h).
 
   // System level faults:
 
-  FaultMap64 m_systemErrors =
-  {
-    {"ARM_EXECUTION_ERROR", std::make_pair(4,false)},
-    {"POWER_EXECUTION_ERROR", std::make_pair(512,false)},
-    {"PT_EXECUTION_ERROR", std::make_pair(128,false)}
-  };
-
-  FaultMap32 m_armErrors = {
-    {"HARDWARE_ERROR", std::make_pair(1, false)},
-    {"TRAJECTORY_GENERATION_ERROR", std::make_pair(2, false)},
-    {"COLLISION_ERROR", std::make_pair(3, false)},
-    {"ESTOP_ERROR", std::make_pair(4, false)},
-    {"POSITION_LIMIT_ERROR", std::make_pair(5, false)},
-    {"TORQUE_LIMIT_ERROR", std::make_pair(6, false)},
-    {"VELOCITY_LIMIT_ERROR", std::make_pair(7, false)},
-    {"NO_FORCE_DATA_ERROR", std::make_pair(8, false)}
-  };
-
-  FaultMap32 m_powerErrors = {
-    {"HARDWARE_ERROR", std::make_pair(1, false)}
-  };
-
-  FaultMap32 m_panTiltErrors = {
-    {"HARDWARE_ERROR", std::make_pair(1, false)},
-    {"JOINT_LIMIT_ERROR", std::make_pair(2, false)}
-  };
+  FaultTable m_systemErrors { "SYSTEM", {
+    {"ARM_EXECUTION_ERROR", 4},
+    {"POWER_EXECUTION_ERROR", 512},
+    {"PT_EXECUTION_ERROR", 128}
+  }};
+
+  FaultTable m_armErrors { "ARM", {
+    {"HARDWARE_ERROR", 1},
+    {"TRAJECTORY_GENERATION_ERROR", 2},
+    {"COLLISION_ERROR", 3},
+    {"ESTOP_ERROR", 4},
+    {"POSITION_LIMIT_ERROR", 5},
+    {"TORQUE_LIMIT_ERROR", 6},
+    {"VELOCITY_LIMIT_ERROR", 7},
+    {"NO_FORCE_DATA_ERROR", 8}
+  }};
+
+  FaultTable m_powerErrors { "POWER", {
+    {"HARDWARE_ERROR", 1}
+  }};
+
+  FaultTable m_panTiltErrors { "ANTENNA", {
+    {"HARDWARE_ERROR", 1},
+    {"JOINT_LIMIT_ERROR", 2}
+  }};
 
   static OwInterface* m_instance;
   ros::NodeHandle* m_genericNodeHandle;
 
+  // Callback processing.  ROS callbacks are split into three categories, each
+  // with its own queue and spinner, so that high-rate telemetry cannot delay
+  // fault handling or action completion.  None of these run on the main
+  // thread, which is left to the PLEXIL executive.
+
+  ros::CallbackQueue m_telemetryQueue;
+  ros::CallbackQueue m_faultQueue;
+  ros::CallbackQueue m_actionQueue;
+  std::unique_ptr<ros::NodeHandle> m_telemetryNodeHandle;
+  std::unique_ptr<ros::NodeHandle> m_faultNodeHandle;
+  std::unique_ptr<ros::NodeHandle> m_actionNodeHandle;
+  std::unique_ptr<ros::AsyncSpinner> m_telemetrySpinner;
+  std::unique_ptr<ros::AsyncSpinner> m_faultSpinner;
+  std::unique_ptr<ros::AsyncSpinner> m_actionSpinner;
+
+  // Runs lander operations; see action_executor.h.
+  std::unique_ptr<ActionExecutor> m_executor;
+
+  // Polls the action servers until all have connected.
+  ros::SteadyTimer m_connectionTimer;
+
+  // Expires operations that have run past their timeouts.
+  ros::Timer m_watchdogTimer;
+
   // Publishers and subscribers
 
   ros::Publisher*  m_antennaTiltPublisher;
   ros::Publisher*  m_antennaPanPublisher;
   ros::Publisher*  m_leftImageTriggerPublisher;
 
-  ros::Subscriber* m_antennaPanSubscriber;
-  ros::Subscriber* m_antennaTiltSubscriber;
   ros::Subscriber* m_jointStatesSubscriber;
-  ros::Subscriber* m_cameraSubscriber;
   ros::Subscriber* m_socSubscriber;
   ros::Subscriber* m_rulSubscriber;
   ros::Subscriber* m_batteryTempSubscriber;
@@ -204,6 +296,12 @@ class OwInterface
   std::unique_ptr<ros::Subscriber> m_armFaultMessagesSubscriber;
   std::unique_ptr<ros::Subscriber> m_powerFaultMessagesSubscriber;
   std::unique_ptr<ros::Subscriber> m_ptFaultMessagesSubscriber;
+  std::unique_ptr<ros::Subscriber> m_cameraInfoSubscriber;
+
+  // Subscribed only on demand (see lazy_subscription.h), and only when images
+  // are retained.  All other telemetry is always needed, for fault detection,
+  // history, and the completion of operations.
+  std::unique_ptr<LazySubscription> m_imageSubscription;
 
   // Action clients
   std::unique_ptr<GuardedMoveActionClient> m_guardedMoveClient;
@@ -213,11 +311,6 @@ class OwInterface
   std::unique_ptr<DigCircularActionClient> m_digCircularClient;
   std::unique_ptr<DigLinearActionClient> m_digLinearClient;
   std::unique_ptr<DeliverActionClient> m_deliverClient;
-
-  // Antenna state - note that pan and tilt can be concurrent.
-  double m_currentPan, m_currentTilt;
-  double m_goalPan, m_goalTilt;      // commanded pan/tilt values
-  ros::Time m_panStart, m_tiltStart; // pan/tilt start times
 };
 
 #endif
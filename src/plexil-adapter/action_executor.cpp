@@ -0,0 +1,66 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "action_executor.h"
+
+#include <ros/ros.h>
+
+ActionExecutor::ActionExecutor (int threads, int queue_capacity)
+  : m_capacity (queue_capacity),
+    m_stopping (false)
+{
+  for (int i = 0; i < threads; i++) {
+    m_workers.emplace_back (&ActionExecutor::work, this);
+  }
+}
+
+ActionExecutor::~ActionExecutor ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stopping = true;
+  }
+  m_ready.notify_all();
+  for (auto& worker : m_workers) worker.join();
+}
+
+bool ActionExecutor::post (Task task)
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    if (m_stopping || m_queue.size() >= m_capacity) return false;
+    m_queue.push_back (std::move (task));
+  }
+  m_ready.notify_one();
+  return true;
+}
+
+void ActionExecutor::postOrRun (Task task)
+{
+  if (! post (task)) {
+    ROS_WARN ("Action executor queue full, running task inline.");
+    task();
+  }
+}
+
+int ActionExecutor::queueDepth () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_queue.size();
+}
+
+void ActionExecutor::work ()
+{
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock (m_mutex);
+      m_ready.wait (lock, [this] { return m_stopping || ! m_queue.empty(); });
+      if (m_queue.empty()) return;  // stopping
+      task = std::move (m_queue.front());
+      m_queue.pop_front();
+    }
+    task();
+  }
+}
@@ -0,0 +1,50 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Action_Executor_H
+#define Ow_Action_Executor_H
+
+// A fixed pool of worker threads with a bounded task queue, used to drive
+// lander operations.  Tasks are expected to be short: operations are started
+// here and finished from completion callbacks, never waited on.
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ActionExecutor
+{
+ public:
+  using Task = std::function<void()>;
+
+  ActionExecutor (int threads, int queue_capacity);
+  ~ActionExecutor ();
+  ActionExecutor (const ActionExecutor&) = delete;
+  ActionExecutor& operator= (const ActionExecutor&) = delete;
+
+  // Queue a task; returns false, dropping the task, if the queue is full.
+  bool post (Task task);
+
+  // Queue a task, or run it in the calling thread if the queue is full.  For
+  // work that must not be lost, such as operation completion.
+  void postOrRun (Task task);
+
+  int queueDepth () const;
+  int threadCount () const { return m_workers.size(); }
+
+ private:
+  void work ();
+
+  const size_t m_capacity;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_ready;
+  std::deque<Task> m_queue;
+  bool m_stopping;
+  std::vector<std::thread> m_workers;
+};
+
+#endif
@@ -2,15 +2,14 @@
 // Research and Simulation can be found in README.md in the root directory of
 // this repository.
 
-// OW autonomy ROS node.
+// OW autonomy ROS node.  A thin wrapper around the startup shared with the
+// autonomy nodelet; see autonomy_startup.h.
 
 // ROS
 #include <ros/ros.h>
-#include <ros/package.h>
 
 // OW
-#include "OwExecutive.h"
-#include "OwInterface.h"
+#include "autonomy_startup.h"
 
 int main(int argc, char* argv[])
 {
@@ -18,40 +17,21 @@ int main(int argc, char* argv[])
 
   ros::init(argc, argv, "autonomy_node");
 
-  if (! OwExecutive::instance()->initialize()) {
-    ROS_ERROR("Could not initialize OW executive, shutting down.");
-    return 1;
-  }
-
-  OwInterface::instance()->initialize();
-
-  // wait for the first proper clock message before running the plan
-  ros::Rate warmup_rate(0.1);
-  ros::Time begin = ros::Time::now();
-  while (ros::Time::now() - begin == ros::Duration(0.0))
-  {
-    ros::spinOnce();
-    warmup_rate.sleep();
-  }
-  
-  // Run the specified plan
-  if (argc == 2) {
-    ROS_INFO ("Running plan %s", argv[1]);
-    OwExecutive::instance()->runPlan (argv[1]); // asynchronous
-  }
-  else {
+  if (argc != 2) {
     ROS_ERROR("autonomy_node got %i args, expected 2", argc);
     return 1;
   }
 
-  // ROS Loop (runs concurrently with plan).  Note that once this loop starts,
-  // this function (and node) is terminated with an interrupt.
+  if (! startAutonomy (argv[1], ros::NodeHandle("~"))) return 1;
 
-  ros::Rate rate(1); // 1 Hz seems appropriate, for now.
-  while (ros::ok()) {
-    ros::spinOnce();
-    rate.sleep();
-  }
+  // OwInterface services its ROS callbacks on its own spinner threads; this
+  // one covers anything left on the global queue.  The main thread simply
+  // waits, leaving the CPU to the PLEXIL executive, until the node is
+  // interrupted.
+
+  ros::AsyncSpinner spinner (1);
+  spinner.start();
+  ros::waitForShutdown();
 
-  return 0;  // We never actually get here!
+  return 0;
 }
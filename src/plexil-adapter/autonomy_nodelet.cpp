@@ -0,0 +1,80 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+// OW autonomy as a nodelet.  Loaded into the same manager as the simulator's
+// nodelets, the messages they publish reach OwInterface as shared pointers,
+// without serialization or copying.  The plan is the nodelet's first argument,
+// or else its private parameter "plan"; other parameters are those of
+// autonomy_node.  Only one may be loaded per process, ever: the executive and
+// lander interface are process-wide, and unloading the nodelet does not stop
+// them, so a later load is refused rather than run on their stale state.
+
+// ROS
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+// OW
+#include "autonomy_startup.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace ow_autonomy
+{
+
+class AutonomyNodelet : public nodelet::Nodelet
+{
+ public:
+  AutonomyNodelet () = default;
+  ~AutonomyNodelet ();
+
+ private:
+  virtual void onInit ();
+
+  std::thread m_startup;
+  std::atomic<bool> m_stopping { false };
+};
+
+void AutonomyNodelet::onInit ()
+{
+  std::string plan;
+  const nodelet::V_string& args = getMyArgv();
+  if (! args.empty()) plan = args[0];
+  else getPrivateNodeHandle().getParam ("plan", plan);
+  if (plan.empty()) {
+    NODELET_ERROR ("No plan given, autonomy not started.");
+    return;
+  }
+  if (! claimAutonomy()) {
+    NODELET_ERROR ("Autonomy was already loaded in this process and can't be "
+                   "loaded again; restart the nodelet manager instead.");
+    return;
+  }
+
+  // onInit must return promptly, and startup waits for the clock.
+  ros::NodeHandle private_nh = getPrivateNodeHandle();
+  m_startup = std::thread ([this, plan, private_nh] () {
+      if (! startAutonomy (plan, private_nh, &m_stopping) &&
+          ! m_stopping.load()) {
+        NODELET_ERROR ("Autonomy nodelet failed to start.");
+      }
+    });
+}
+
+AutonomyNodelet::~AutonomyNodelet ()
+{
+  // The startup thread runs code in this nodelet's library, which may be
+  // unloaded once we return, so it is stopped (waiting for the clock notices
+  // within a second) and joined.  The executive and lander interface are
+  // process-wide singletons that outlive the nodelet.
+  if (! m_startup.joinable()) return;
+  m_stopping = true;
+  m_startup.join();
+  NODELET_WARN ("Autonomy keeps running until the nodelet manager exits.");
+}
+
+} // namespace ow_autonomy
+
+PLUGINLIB_EXPORT_CLASS (ow_autonomy::AutonomyNodelet, nodelet::Nodelet)
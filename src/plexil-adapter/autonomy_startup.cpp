@@ -0,0 +1,37 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "autonomy_startup.h"
+#include "OwExecutive.h"
+#include "OwInterface.h"
+
+bool startAutonomy (const std::string& plan, const ros::NodeHandle& private_nh,
+                    const std::atomic<bool>* stop)
+{
+  if (! OwExecutive::instance()->initialize()) {
+    ROS_ERROR("Could not initialize OW executive, shutting down.");
+    return false;
+  }
+
+  OwInterface::instance()->initialize (private_nh);
+
+  // Wait for the first proper clock message before running the plan.  The
+  // timeout, in seconds, is optional; by default we wait indefinitely.
+  double clock_timeout = private_nh.param ("clock_timeout", 0.0);
+  if (! OwExecutive::instance()->waitForClock (clock_timeout, stop)) {
+    if (stop && stop->load()) return false;
+    ROS_ERROR("Simulation clock not running, shutting down.");
+    return false;
+  }
+
+  ROS_INFO ("Running plan %s", plan.c_str());
+  OwExecutive::instance()->runPlan (plan); // asynchronous
+  return true;
+}
+
+bool claimAutonomy ()
+{
+  static std::atomic<bool> claimed { false };
+  return ! claimed.exchange (true);
+}
@@ -0,0 +1,31 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Autonomy_Startup_H
+#define Ow_Autonomy_Startup_H
+
+// Startup of the autonomy stack, shared by the autonomy_node executable and
+// the autonomy nodelet (see autonomy_nodelet.cpp).
+
+#include <ros/ros.h>
+#include <atomic>
+#include <string>
+
+// Initialize the PLEXIL executive and the lander interface, wait for the
+// simulation clock, and start the given plan, which then runs asynchronously.
+// Configuration is read from the given (private) node handle.  Returns false,
+// having logged why, if any step fails, or (quietly) if 'stop' is set while
+// waiting for the clock.  Only one autonomy stack can run per process, since
+// the executive is a singleton.
+
+bool startAutonomy (const std::string& plan, const ros::NodeHandle& private_nh,
+                    const std::atomic<bool>* stop = nullptr);
+
+// Claim the process's autonomy stack for a caller about to start it.  Returns
+// false if it was claimed before: once started, the stack runs until the
+// process exits, and can't be started again.
+
+bool claimAutonomy ();
+
+#endif
@@ -0,0 +1,221 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Command_Slab_H
+#define Ow_Command_Slab_H
+
+// A fixed-capacity table of records of commands in progress.  Each command is
+// addressed by a handle combining its slot with the slot's generation, which
+// changes each time the slot is recycled, so a late reference to a finished
+// command is recognized as stale rather than hitting its slot's next user.
+// State transitions are single atomic operations on a per-slot word; free
+// slots are kept on a lock-free stack.
+//
+// A command's life: allocate() (the executive's thread only), then at most one
+// beginSent()/endSent() pair to acknowledge that it was sent, then claim()
+// when it finishes and release() once its final acknowledgement is out.
+// claim() waits out a send in progress, so the "sent" ack can never follow the
+// final one.  An abort may be requested at any point before claim(), which
+// reports it, so that exactly one party answers the abort.
+//
+// A slot's record is written only by allocate(), while the slot is free, and
+// read by other threads only after claim(), so it needs no lock.  find() reads
+// records of slots in use, so it too is for the allocating thread only.
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+template <typename Record>
+class CommandSlab
+{
+ public:
+  static const int SlotBits = 10;
+  static const int MaxCapacity = 1 << SlotBits;
+
+  explicit CommandSlab (int capacity)
+    : m_slots (capacity < 1 ? 1 :
+               capacity > MaxCapacity ? MaxCapacity : capacity),
+      m_freeHead (-1)
+  {
+    for (int i = m_slots.size() - 1; i >= 0; i--) push_free (i);
+  }
+
+  CommandSlab (const CommandSlab&) = delete;
+  CommandSlab& operator= (const CommandSlab&) = delete;
+
+  // Returns the new command's handle, or -1 if every slot is in use.  Only
+  // one thread may allocate.
+  int allocate (const Record& record)
+  {
+    int slot = pop_free();
+    if (slot < 0) return -1;
+    Slot& s = m_slots[slot];
+    s.record = record;
+    uint32_t gen = generation (s.word.load());
+    s.word.store (word (gen, Active));
+    int in_use = m_inUse.fetch_add (1) + 1;
+    int high = m_highWater.load();
+    while (in_use > high && ! m_highWater.compare_exchange_weak (high, in_use))
+      { }
+    return static_cast<int>((gen << SlotBits) | slot);
+  }
+
+  // Begin the "sent" acknowledgement.  False if the command has finished or
+  // was already acknowledged; otherwise endSent() must follow.
+  bool beginSent (int handle)
+  {
+    Slot* s = slot (handle);
+    if (! s) return false;
+    uint32_t expected = word (handle_generation (handle), Active);
+    return s->word.compare_exchange_strong (expected,
+                                            word (handle_generation (handle),
+                                                  Sending));
+  }
+
+  void endSent (int handle)
+  {
+    // Sending -> Sent, keeping any abort request.
+    slot (handle)->word.fetch_add (Sent - Sending);
+  }
+
+  // Request an abort of the command.  False if the handle is stale or the
+  // command was already claimed, in which case its completion will not report
+  // the abort.
+  bool requestAbort (int handle)
+  {
+    Slot* s = slot (handle);
+    if (! s) return false;
+    uint32_t gen = handle_generation (handle);
+    uint32_t w = s->word.load();
+    do {
+      if (generation (w) != gen) return false;
+      uint32_t st = state (w);
+      if (st == Free || st == Claimed) return false;
+    } while (! s->word.compare_exchange_weak (w, w | AbortBit));
+    return true;
+  }
+
+  // Take the command for completion, copying out its record and whether an
+  // abort was requested.  False if the handle is stale or the command was
+  // already claimed.
+  bool claim (int handle, Record& record, bool& abort_requested)
+  {
+    Slot* s = slot (handle);
+    if (! s) return false;
+    uint32_t gen = handle_generation (handle);
+    while (true) {
+      uint32_t w = s->word.load();
+      if (generation (w) != gen) return false;
+      uint32_t st = state (w);
+      if (st == Free || st == Claimed) return false;
+      if (st == Sending) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (s->word.compare_exchange_weak (w, word (gen, Claimed))) {
+        record = s->record;
+        abort_requested = w & AbortBit;
+        return true;
+      }
+    }
+  }
+
+  // Recycle a claimed command's slot.  The record is left in place, as find()
+  // may be reading it; the slot's next allocate() overwrites it.
+  void release (int handle)
+  {
+    Slot* s = slot (handle);
+    uint32_t gen = (handle_generation (handle) + 1) & GenerationMask;
+    s->word.store (word (gen, Free));
+    m_inUse.fetch_sub (1);
+    push_free (handle & SlotMask);
+  }
+
+  // Handle of the first active command whose record satisfies the predicate,
+  // or -1.  The command may be in the middle of finishing, in which case the
+  // handle is stale by the time it is used.  Only the allocating thread may
+  // call this, so no record changes while it is read.
+  template <typename Pred>
+  int find (Pred pred) const
+  {
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      uint32_t w = m_slots[i].word.load();
+      uint32_t st = state (w);
+      if (st == Free || st == Claimed) continue;
+      if (! pred (m_slots[i].record)) continue;
+      // The generation read first must still be the record's.
+      if (generation (m_slots[i].word.load()) != generation (w)) continue;
+      return static_cast<int>((generation (w) << SlotBits) | i);
+    }
+    return -1;
+  }
+
+  int capacity () const { return m_slots.size(); }
+  int inUse () const { return m_inUse.load(); }
+  int highWater () const { return m_highWater.load(); }
+
+ private:
+  enum State : uint32_t { Free, Active, Sending, Sent, Claimed };
+
+  static const uint32_t SlotMask = MaxCapacity - 1;
+  static const int StateBits = 4;          // state, then the abort bit
+  static const uint32_t AbortBit = 1u << 3;
+  // Handles are non-negative ints, distinct from the -1 used for "none".
+  static const uint32_t GenerationMask = (1u << (31 - SlotBits)) - 1;
+
+  static uint32_t word (uint32_t gen, uint32_t st)
+  {
+    return (gen << StateBits) | st;
+  }
+  static uint32_t generation (uint32_t w) { return w >> StateBits; }
+  static uint32_t state (uint32_t w) { return w & (AbortBit - 1); }
+  static uint32_t handle_generation (int handle)
+  {
+    return static_cast<uint32_t>(handle) >> SlotBits;
+  }
+
+  struct Slot
+  {
+    std::atomic<uint32_t> word { 0 };
+    std::atomic<int> nextFree { -1 };
+    Record record;
+  };
+
+  Slot* slot (int handle)
+  {
+    if (handle < 0) return nullptr;
+    size_t i = handle & SlotMask;
+    return i < m_slots.size() ? &m_slots[i] : nullptr;
+  }
+
+  // Any thread may push; only the allocating thread pops, so a slot cannot
+  // be popped and pushed back between a pop's read of the head and its
+  // exchange.
+  void push_free (int i)
+  {
+    int head = m_freeHead.load();
+    do {
+      m_slots[i].nextFree.store (head);
+    } while (! m_freeHead.compare_exchange_weak (head, i));
+  }
+
+  int pop_free ()
+  {
+    int head = m_freeHead.load();
+    while (head >= 0 &&
+           ! m_freeHead.compare_exchange_weak (head,
+                                               m_slots[head].nextFree.load()))
+      { }
+    return head;
+  }
+
+  std::vector<Slot> m_slots;
+  std::atomic<int> m_freeHead;
+  std::atomic<int> m_inUse { 0 };
+  std::atomic<int> m_highWater { 0 };
+};
+
+#endif
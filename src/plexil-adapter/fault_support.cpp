@@ -0,0 +1,41 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "fault_support.h"
+
+#include <ros/ros.h>
+
+FaultTable::FaultTable (const std::string& component,
+                        std::initializer_list<FaultDefinition> faults)
+  : m_component (component),
+    m_faults (faults),
+    m_dependents { },
+    m_word (0),
+    m_active (0),
+    m_activeCount (0)
+{
+  if (m_faults.size() > 64) {
+    ROS_ERROR ("%s: only the first 64 faults are supported.",
+               component.c_str());
+    m_faults.resize (64);
+  }
+  for (size_t i = 0; i < m_faults.size(); i++) {
+    // A fault with no bits could never be told apart from no fault.
+    if (m_faults[i].value == 0) {
+      ROS_ERROR ("%s fault %s has no bits, ignoring it.",
+                 component.c_str(), m_faults[i].name.c_str());
+    }
+    for (int bit = 0; bit < 64; bit++) {
+      if (m_faults[i].value & (1ULL << bit)) m_dependents[bit] |= 1ULL << i;
+    }
+    m_masks.emplace (m_faults[i].name, 1ULL << i);
+  }
+}
+
+bool FaultTable::active (const std::string& fault_name) const
+{
+  auto entry = m_masks.find (fault_name);
+  if (entry == m_masks.end()) return false;
+  return m_active.load() & entry->second;
+}
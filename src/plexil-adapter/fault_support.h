@@ -0,0 +1,92 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef OW_AUTONOMY_FAULT_SUPPORT_H
+#define OW_AUTONOMY_FAULT_SUPPORT_H
+
+// Support for lander faults, based on the ROS fault status messages, each of
+// which carries one component's faults as a word of bits.
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FaultDefinition
+{
+  // Use compiler's default methods.
+  std::string name;
+  uint64_t value;  // fault is active when all of these bits are set
+};
+
+// The faults of one component.  The table is compiled once into, for each bit
+// of the fault word, the set of faults depending on it, so that decoding a new
+// word looks only at faults whose bits changed; and into a map from fault name
+// to its bit of the active mask, so that a query is one hash lookup.  At most
+// 64 faults per component.  Decoding must be done by a single thread; queries
+// are safe from any thread.
+
+class FaultTable
+{
+ public:
+  FaultTable (const std::string& component,
+              std::initializer_list<FaultDefinition> faults);
+  FaultTable (const FaultTable&) = delete;
+  FaultTable& operator= (const FaultTable&) = delete;
+
+  const std::string& component () const { return m_component; }
+
+  // Decode a new fault word, calling on_change (fault_name, active) for each
+  // fault that changed state.
+  template <typename F>
+  void update (uint64_t word, F on_change);
+
+  bool anyActive () const { return activeCount() > 0; }
+  int activeCount () const { return m_activeCount.load(); }
+
+  // Is the named fault active?  False for unknown names.
+  bool active (const std::string& fault_name) const;
+
+  const std::vector<FaultDefinition>& faults () const { return m_faults; }
+
+ private:
+  std::string m_component;
+  std::vector<FaultDefinition> m_faults;
+  std::unordered_map<std::string, uint64_t> m_masks;  // fault name -> its bit
+  uint64_t m_dependents[64];             // by bit: faults using it, as a mask
+  uint64_t m_word;                       // last word decoded
+  std::atomic<uint64_t> m_active;        // active faults, as a mask
+  std::atomic<int> m_activeCount;
+};
+
+template <typename F>
+void FaultTable::update (uint64_t word, F on_change)
+{
+  uint64_t changed_bits = word ^ m_word;
+  if (changed_bits == 0) return;
+  m_word = word;
+
+  uint64_t affected = 0;
+  for (uint64_t bits = changed_bits; bits; bits &= bits - 1) {
+    affected |= m_dependents[__builtin_ctzll (bits)];
+  }
+
+  uint64_t active = m_active.load();
+  for (uint64_t faults = affected; faults; faults &= faults - 1) {
+    int i = __builtin_ctzll (faults);
+    uint64_t value = m_faults[i].value;
+    bool now_active = (word & value) == value;
+    bool was_active = active & (1ULL << i);
+    if (now_active != was_active) {
+      active ^= 1ULL << i;
+      on_change (m_faults[i].name, now_active);
+    }
+  }
+  m_active.store (active);
+  m_activeCount.store (__builtin_popcountll (active));
+}
+
+#endif
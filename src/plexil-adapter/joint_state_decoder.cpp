@@ -0,0 +1,90 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "joint_state_decoder.h"
+
+#include <ros/ros.h>
+
+#include <algorithm>
+
+using std::string;
+using std::vector;
+
+// FNV-1a over the names, each terminated so that ["ab","c"] and ["a","bc"]
+// differ.
+static uint64_t layout_hash (const vector<string>& names)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (const auto& name : names) {
+    for (unsigned char c : name) {
+      hash = (hash ^ c) * 1099511628211ULL;
+    }
+    hash = (hash ^ 0xff) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+JointStateDecoder::JointStateDecoder (Resolver resolve)
+  : m_resolve (resolve),
+    m_hash (0)
+{
+}
+
+void JointStateDecoder::relayout (const vector<string>& names, uint64_t hash)
+{
+  m_hash = hash;
+  m_joints.assign (names.size(), -1);
+  uint32_t seen = 0;
+  for (size_t i = 0; i < names.size(); i++) {
+    Joint joint;
+    if (! m_resolve (names[i], joint)) {
+      ROS_ERROR ("joint_states: unsupported joint %s", names[i].c_str());
+      continue;
+    }
+    uint32_t bit = 1u << jointIndex (joint);
+    if (seen & bit) {
+      ROS_ERROR ("joint_states: joint %s given more than once, "
+                 "using the first.", names[i].c_str());
+      continue;
+    }
+    seen |= bit;
+    m_joints[i] = jointIndex (joint);
+  }
+  if (seen != (1u << NumJoints) - 1) {
+    ROS_WARN ("joint_states: message does not carry all lander joints.");
+  }
+  ROS_DEBUG ("joint_states: layout of %zu names cached.", names.size());
+}
+
+void JointStateDecoder::decode (const sensor_msgs::JointState& msg,
+                                JointStateBuffer& out)
+{
+  uint64_t hash = layout_hash (msg.name);
+  if (hash != m_hash || m_joints.size() != msg.name.size()) {
+    relayout (msg.name, hash);
+  }
+
+  // The value arrays should match the names, but velocity and effort are
+  // optional and may be left empty.
+  size_t positions = std::min (msg.position.size(), m_joints.size());
+  size_t velocities = std::min (msg.velocity.size(), positions);
+  size_t efforts = std::min (msg.effort.size(), positions);
+
+  out.present = out.hasVelocity = out.hasEffort = 0;
+  for (size_t i = 0; i < positions; i++) {
+    int j = m_joints[i];
+    if (j < 0) continue;
+    uint32_t bit = 1u << j;
+    out.present |= bit;
+    out.position[j] = msg.position[i];
+    if (i < velocities) {
+      out.velocity[j] = msg.velocity[i];
+      out.hasVelocity |= bit;
+    }
+    if (i < efforts) {
+      out.effort[j] = msg.effort[i];
+      out.hasEffort |= bit;
+    }
+  }
+}
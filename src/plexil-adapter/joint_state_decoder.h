@@ -0,0 +1,61 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Joint_State_Decoder_H
+#define Ow_Joint_State_Decoder_H
+
+// Decoding of /joint_states messages.  The publisher sends the same joints in
+// the same order every time, so the message's name ordering is resolved to
+// joints once and cached as a permutation; each message after that is decoded
+// by indexed copies.  The layout is recomputed only when a hash of the names
+// changes.
+
+#include "joint_support.h"
+
+#include <sensor_msgs/JointState.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// The joints of one message, as a structure of arrays indexed by jointIndex().
+// Only the joints in 'present' were in the message; velocity and effort are
+// reported separately because publishers may leave those arrays short.
+struct JointStateBuffer
+{
+  uint32_t present = 0;          // by joint bit: position given
+  uint32_t hasVelocity = 0;      // by joint bit
+  uint32_t hasEffort = 0;        // by joint bit
+  double position[NumJoints];
+  double velocity[NumJoints];
+  double effort[NumJoints];
+
+  bool has (Joint joint) const { return present & (1u << jointIndex (joint)); }
+};
+
+class JointStateDecoder
+{
+ public:
+  // Maps a ROS joint name to a joint, returning false for joints not
+  // supported.  Called only when the layout changes.
+  using Resolver = std::function<bool (const std::string&, Joint&)>;
+
+  JointStateDecoder (Resolver resolve);
+  JointStateDecoder (const JointStateDecoder&) = delete;
+  JointStateDecoder& operator= (const JointStateDecoder&) = delete;
+
+  // Decode the message into the buffer, which is overwritten.  Not thread
+  // safe; use one decoder per subscriber.
+  void decode (const sensor_msgs::JointState& msg, JointStateBuffer& out);
+
+ private:
+  void relayout (const std::vector<std::string>& names, uint64_t hash);
+
+  Resolver m_resolve;
+  uint64_t m_hash;              // of the names in the cached layout
+  std::vector<int> m_joints;    // by message index: joint index, or -1
+};
+
+#endif
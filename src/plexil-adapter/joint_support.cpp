@@ -0,0 +1,146 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "joint_support.h"
+#include "telemetry_filter.h"
+
+// C++
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+using std::string;
+
+static JointProperties joint_defaults (const string& ros_name,
+                                       const string& plexil_name,
+                                       double soft_torque_limit,
+                                       double hard_torque_limit,
+                                       double torque_hysteresis)
+{
+  return JointProperties { ros_name, plexil_name,
+                           soft_torque_limit, hard_torque_limit,
+                           torque_hysteresis,
+                           0, 0, 0,
+                           plexil_name + "Position",
+                           plexil_name + "Velocity",
+                           plexil_name + "Effort" };
+}
+
+// Indexed by joint, so in the order of the Joint enumeration.
+static std::array<JointProperties, NumJoints> JointTable {{
+  // NOTE: Torque limits are made up.  Assuming that only magnitude matters.
+  joint_defaults ("j_shou_yaw", "ShoulderYaw", 60, 80, 5),
+  joint_defaults ("j_shou_pitch", "ShoulderPitch", 60, 80, 5),
+  joint_defaults ("j_prox_pitch", "ProximalPitch", 60, 80, 5),
+  joint_defaults ("j_dist_pitch", "DistalPitch", 60, 80, 5),
+  joint_defaults ("j_hand_yaw", "HandYaw", 60, 80, 5),
+  joint_defaults ("j_scoop_yaw", "ScoopYaw", 60, 80, 5),
+  joint_defaults ("j_ant_pan", "AntennaPan", 30, 30, 2),
+  joint_defaults ("j_ant_tilt", "AntennaTilt", 30, 30, 2),
+  joint_defaults ("j_grinder", "Grinder", 30, 30, 2)
+}};
+
+static std::unordered_map<string, Joint> RosNames;
+static std::unordered_map<string, Joint> PlexilNames;
+
+static bool index_names ()
+{
+  RosNames.clear();
+  PlexilNames.clear();
+  for (int i = 0; i < NumJoints; i++) {
+    RosNames[JointTable[i].rosName] = static_cast<Joint>(i);
+    PlexilNames[JointTable[i].plexilName] = static_cast<Joint>(i);
+  }
+  return RosNames.size() == NumJoints;
+}
+
+// Index the defaults, for use before (or without) loadJointTable.
+static bool DefaultsIndexed = index_names();
+
+static void load_joint (const ros::NodeHandle& nh, JointProperties& joint)
+{
+  const string prefix = "joints/" + joint.plexilName + "/";
+  JointProperties loaded = joint;
+  nh.param (prefix + "ros_name", loaded.rosName, joint.rosName);
+  nh.param (prefix + "soft_torque_limit", loaded.softTorqueLimit,
+            joint.softTorqueLimit);
+  nh.param (prefix + "hard_torque_limit", loaded.hardTorqueLimit,
+            joint.hardTorqueLimit);
+  nh.param (prefix + "torque_hysteresis", loaded.torqueHysteresis,
+            joint.torqueHysteresis);
+  nh.param (prefix + "position_deadband", loaded.positionDeadband,
+            joint.positionDeadband);
+  nh.param (prefix + "velocity_deadband", loaded.velocityDeadband,
+            joint.velocityDeadband);
+  nh.param (prefix + "effort_deadband", loaded.effortDeadband,
+            joint.effortDeadband);
+
+  if (loaded.softTorqueLimit <= 0 ||
+      loaded.hardTorqueLimit < loaded.softTorqueLimit ||
+      loaded.torqueHysteresis < 0 ||
+      loaded.torqueHysteresis >= loaded.softTorqueLimit) {
+    ROS_ERROR ("Invalid torque limits for joint %s, using defaults.",
+               joint.plexilName.c_str());
+    loaded.softTorqueLimit = joint.softTorqueLimit;
+    loaded.hardTorqueLimit = joint.hardTorqueLimit;
+    loaded.torqueHysteresis = joint.torqueHysteresis;
+  }
+  joint = loaded;
+}
+
+static void add_filter (const string& state_name, double deadband)
+{
+  if (deadband <= 0) return;
+  TelemetryFilterSpec spec;
+  spec.absoluteDeadband = deadband;
+  // A filter given for the exact state in the adapter configuration wins.
+  setTelemetryFilter (state_name, spec, false);
+}
+
+void loadJointTable (const ros::NodeHandle& nh)
+{
+  std::array<JointProperties, NumJoints> loaded = JointTable;
+  for (auto& joint : loaded) load_joint (nh, joint);
+
+  // A ROS name given to two joints would leave one of them without telemetry.
+  std::unordered_set<string> ros_names;
+  for (const auto& joint : loaded) {
+    if (! ros_names.insert (joint.rosName).second) {
+      ROS_ERROR ("ROS joint name %s is given to more than one joint, "
+                 "using the built-in joint table.", joint.rosName.c_str());
+      return;
+    }
+  }
+
+  JointTable = loaded;
+  for (const auto& joint : JointTable) {
+    add_filter (joint.positionState, joint.positionDeadband);
+    add_filter (joint.velocityState, joint.velocityDeadband);
+    add_filter (joint.effortState, joint.effortDeadband);
+  }
+  index_names();
+}
+
+const JointProperties& jointProperties (Joint joint)
+{
+  return JointTable[jointIndex (joint)];
+}
+
+static bool find_joint (const std::unordered_map<string, Joint>& names,
+                        const string& name, Joint& joint)
+{
+  auto entry = names.find (name);
+  if (entry == names.end()) return false;
+  joint = entry->second;
+  return true;
+}
+
+bool rosNameToJoint (const string& ros_name, Joint& joint)
+{
+  return find_joint (RosNames, ros_name, joint);
+}
+
+bool plexilNameToJoint (const string& plexil_name, Joint& joint)
+{
+  return find_joint (PlexilNames, plexil_name, joint);
+}
@@ -7,6 +7,11 @@
 
 // Support for lander joints, based on ROS /joint_states message.
 
+#include <ros/ros.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <string>
 
 enum class Joint {
@@ -21,6 +26,10 @@ enum class Joint {
   grinder
 };
 
+const int NumJoints = static_cast<int>(Joint::grinder) + 1;
+
+inline int jointIndex (Joint joint) { return static_cast<int>(joint); }
+
 struct JointProperties
 {
   // Use compiler's default methods.
@@ -28,8 +37,36 @@ struct JointProperties
   std::string plexilName; // human-readable, no spaces
   double softTorqueLimit;
   double hardTorqueLimit;
+  double torqueHysteresis; // a limit clears once below it by this much
+
+  // Telemetry filter deadbands (see telemetry_filter.h); 0 leaves the
+  // state's filtering to the adapter configuration.
+  double positionDeadband;
+  double velocityDeadband;
+  double effortDeadband;
+
+  // Names of the joint's PLEXIL states, derived from plexilName.
+  std::string positionState;
+  std::string velocityState;
+  std::string effortState;
 };
 
+// The joint table.  Built-in defaults may be overridden by the node's private
+// parameters joints/<plexilName>/{ros_name, soft_torque_limit,
+// hard_torque_limit, torque_hysteresis, position_deadband, velocity_deadband,
+// effort_deadband}, typically loaded from a YAML file by the launch file.
+// Parameters that give two joints the same ROS name are rejected as a whole,
+// leaving the built-in table.  Load the table before any callbacks that use it
+// are running; it is read only after that.
+
+void loadJointTable (const ros::NodeHandle& nh);
+
+const JointProperties& jointProperties (Joint joint);
+
+// Name -> joint.  False if there is no such joint.
+bool rosNameToJoint (const std::string& ros_name, Joint& joint);
+bool plexilNameToJoint (const std::string& plexil_name, Joint& joint);
+
 struct JointTelemetry
 {
   JointTelemetry (double p = 0, double v = 0, double e = 0)
@@ -44,4 +81,74 @@ struct JointTelemetry
   double effort;
 };
 
+// Which joints are at their soft and hard torque limits, kept as one bit per
+// joint.  A limit is reached when the magnitude of effort meets it, and cleared
+// only when effort falls below it by the joint's hysteresis, so that noise
+// about a limit does not produce a stream of transitions.  The limits are
+// independent: a joint at its hard limit is normally at its soft limit too.
+// Updates must come from a single thread; queries are safe from any thread.
+
+enum class TorqueLimit { Soft, Hard };
+
+class TorqueLimitState
+{
+ public:
+  TorqueLimitState ()
+  {
+    for (auto& reached : m_reached) reached.store (0);
+    for (auto& limit : m_transitions) {
+      for (auto& time : limit) time.store (0);
+    }
+  }
+  TorqueLimitState (const TorqueLimitState&) = delete;
+  TorqueLimitState& operator= (const TorqueLimitState&) = delete;
+
+  // Update the joint with its latest effort at the given time, calling
+  // on_change (limit, reached) for each limit whose state changed.
+  template <typename F>
+  void update (Joint joint, const JointProperties& props, double effort,
+               double time, F on_change)
+  {
+    double magnitude = fabs (effort);
+    check (TorqueLimit::Soft, joint, props.softTorqueLimit,
+           props.torqueHysteresis, magnitude, time, on_change);
+    check (TorqueLimit::Hard, joint, props.hardTorqueLimit,
+           props.torqueHysteresis, magnitude, time, on_change);
+  }
+
+  bool reached (Joint joint, TorqueLimit limit) const
+  {
+    return m_reached[index (limit)].load() & bit (joint);
+  }
+
+  // Time of the joint's last transition into or out of the limit, or 0 if
+  // there has been none.
+  double lastTransition (Joint joint, TorqueLimit limit) const
+  {
+    return m_transitions[index (limit)][jointIndex (joint)].load();
+  }
+
+ private:
+  static int index (TorqueLimit limit) { return static_cast<int>(limit); }
+  static uint32_t bit (Joint joint) { return 1u << jointIndex (joint); }
+
+  template <typename F>
+  void check (TorqueLimit limit, Joint joint, double threshold,
+              double hysteresis, double magnitude, double time, F& on_change)
+  {
+    std::atomic<uint32_t>& reached = m_reached[index (limit)];
+    bool was_reached = reached.load() & bit (joint);
+    bool now_reached = was_reached ?
+      magnitude > threshold - hysteresis : magnitude >= threshold;
+    if (now_reached == was_reached) return;
+    if (now_reached) reached.fetch_or (bit (joint));
+    else reached.fetch_and (~bit (joint));
+    m_transitions[index (limit)][jointIndex (joint)].store (time);
+    on_change (limit, now_reached);
+  }
+
+  std::atomic<uint32_t> m_reached[2];
+  std::atomic<double> m_transitions[2][NumJoints];
+};
+
 #endif
@@ -0,0 +1,45 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "lazy_subscription.h"
+
+LazySubscription::LazySubscription (const std::string& topic,
+                                    Subscribe subscribe)
+  : m_topic (topic),
+    m_subscribe (subscribe),
+    m_demand (0)
+{
+}
+
+void LazySubscription::acquire ()
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  if (m_demand++ > 0) return;
+  ROS_DEBUG ("Subscribing to %s", m_topic.c_str());
+  m_subscriber = m_subscribe();
+}
+
+void LazySubscription::release ()
+{
+  ros::Subscriber unneeded;
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    if (m_demand == 0) {
+      ROS_WARN ("%s released more often than acquired.", m_topic.c_str());
+      return;
+    }
+    if (--m_demand > 0) return;
+    ROS_DEBUG ("Unsubscribing from %s", m_topic.c_str());
+    std::swap (unneeded, m_subscriber);
+  }
+  // Shut down outside the lock: shutdown waits for a callback in progress,
+  // which may itself be waiting to acquire or release.
+  unneeded.shutdown();
+}
+
+bool LazySubscription::active () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_demand > 0;
+}
@@ -0,0 +1,47 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Lazy_Subscription_H
+#define Ow_Lazy_Subscription_H
+
+// A ROS subscription that exists only while something needs it.  Demand is
+// reference counted: the first acquire() subscribes to the topic and the last
+// release() unsubscribes, so that a topic nobody needs costs neither bandwidth
+// nor deserialization.  Safe to use from any thread, including the
+// subscription's own callback.
+
+#include <ros/ros.h>
+
+#include <functional>
+#include <mutex>
+#include <string>
+
+class LazySubscription
+{
+ public:
+  // Makes the subscription, e.g. by calling NodeHandle::subscribe.
+  using Subscribe = std::function<ros::Subscriber()>;
+
+  LazySubscription (const std::string& topic, Subscribe subscribe);
+  LazySubscription (const LazySubscription&) = delete;
+  LazySubscription& operator= (const LazySubscription&) = delete;
+
+  void acquire ();
+  void release ();
+
+  // Is the topic subscribed?  A new subscription misses messages published
+  // before it has connected to their publisher.
+  bool active () const;
+
+  const std::string& topic () const { return m_topic; }
+
+ private:
+  const std::string m_topic;
+  const Subscribe m_subscribe;
+  mutable std::mutex m_mutex;
+  int m_demand;
+  ros::Subscriber m_subscriber;
+};
+
+#endif
@@ -0,0 +1,77 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Mpsc_Queue_H
+#define Ow_Mpsc_Queue_H
+
+// An unbounded multi-producer, single-consumer queue.  Producers never block
+// or take a lock: a push is one allocation and one atomic exchange.  Only one
+// thread may pop.  (This is the well-known linked-list design with a stub
+// node; a push becomes visible to the consumer when it links its node, so an
+// item being pushed concurrently with a pop may be seen only by a later one.)
+
+#include <atomic>
+#include <utility>
+
+template <typename T>
+class MpscQueue
+{
+ public:
+  MpscQueue ()
+    : m_tail (new Node)
+  {
+    m_head.store (m_tail);
+  }
+
+  ~MpscQueue ()
+  {
+    T discard;
+    while (pop (discard)) { }
+    delete m_tail;
+  }
+
+  MpscQueue (const MpscQueue&) = delete;
+  MpscQueue& operator= (const MpscQueue&) = delete;
+
+  // Any thread.
+  void push (T value)
+  {
+    Node* node = new Node;
+    node->value = std::move (value);
+    m_size.fetch_add (1);
+    Node* prev = m_head.exchange (node);
+    prev->next.store (node);
+  }
+
+  // Consumer only.  Returns false if the queue is (momentarily) empty.
+  bool pop (T& value)
+  {
+    Node* next = m_tail->next.load();
+    if (! next) return false;
+    value = std::move (next->value);
+    delete m_tail;
+    m_tail = next;
+    m_size.fetch_sub (1);
+    return true;
+  }
+
+  // Consumer only.
+  bool empty () const { return m_tail->next.load() == nullptr; }
+
+  // Approximate number of items queued; any thread.
+  int size () const { return m_size.load (std::memory_order_relaxed); }
+
+ private:
+  struct Node
+  {
+    std::atomic<Node*> next { nullptr };
+    T value;
+  };
+
+  std::atomic<Node*> m_head;   // last pushed
+  Node* m_tail;                // stub: its successor is the next to pop
+  std::atomic<int> m_size { 0 };
+};
+
+#endif
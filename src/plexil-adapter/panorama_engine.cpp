@@ -0,0 +1,298 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "panorama_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+bool validPanorama (const PanoramaSpec& spec, std::string& error)
+{
+  std::ostringstream reason;
+  if (spec.tiltLo > spec.tiltHi ||
+      spec.tiltLo < TiltMin || spec.tiltHi > TiltMax) {
+    reason << "tilt range outside " << TiltMin << " to " << TiltMax;
+  }
+  else if (spec.panLo > spec.panHi ||
+           spec.panLo < PanMin || spec.panHi > PanMax) {
+    reason << "pan range outside " << PanMin << " to " << PanMax;
+  }
+  else if (spec.vertOverlap < 0 || spec.vertOverlap >= VerticalFov / 2) {
+    reason << "vertical overlap not less than " << VerticalFov / 2;
+  }
+  else if (spec.horizOverlap < 0 || spec.horizOverlap >= HorizontalFov / 2) {
+    reason << "horizontal overlap not less than " << HorizontalFov / 2;
+  }
+  error = reason.str();
+  return error.empty();
+}
+
+static std::vector<double> axis_steps (double lo, double hi, double increment)
+{
+  std::vector<double> steps;
+  for (int i = 0; lo + i * increment < hi; i++) {
+    steps.push_back (lo + i * increment);
+  }
+  steps.push_back (hi);
+  return steps;
+}
+
+std::vector<PanoramaTile> panoramaGrid (const PanoramaSpec& spec)
+{
+  std::vector<double> tilts = axis_steps
+    (spec.tiltLo, spec.tiltHi, VerticalFov / 2 - spec.vertOverlap);
+  std::vector<double> pans = axis_steps
+    (spec.panLo, spec.panHi, HorizontalFov / 2 - spec.horizOverlap);
+
+  std::vector<PanoramaTile> tiles;
+  tiles.reserve (tilts.size() * pans.size());
+  for (int row = 0; row < (int) tilts.size(); row++) {
+    for (int column = 0; column < (int) pans.size(); column++) {
+      tiles.push_back ({ (int) tiles.size(), row, column,
+                         tilts[row], pans[column] });
+    }
+  }
+  return tiles;
+}
+
+bool validTileMask (const std::string& mask, size_t tiles)
+{
+  return mask.size() == tiles &&
+    mask.find_first_not_of ("01") == std::string::npos;
+}
+
+const char* panoramaStateName (PanoramaState state)
+{
+  switch (state) {
+    case PanoramaState::Idle:      return "Idle";
+    case PanoramaState::Slewing:   return "Slewing";
+    case PanoramaState::Capturing: return "Capturing";
+  }
+  return "Unknown";
+}
+
+// Learning of the slew model.  Each slew or capture observed moves the model
+// this fraction of the way to what was observed.  Rates are learned only from
+// slews long enough for the axis to get up to speed.
+static const double LearningRate = 0.2;
+static const double MinLearningSlew = 2.0;  // degrees
+
+static void learn (double& estimate, double observed)
+{
+  estimate += LearningRate * (observed - estimate);
+}
+
+PanoramaEngine::PanoramaEngine (Hooks hooks, const SlewModel& model,
+                                double position_tolerance,
+                                double velocity_tolerance)
+  : m_hooks (hooks),
+    m_positionTolerance (position_tolerance),
+    m_velocityTolerance (velocity_tolerance),
+    m_model (model),
+    m_pan (0),
+    m_tilt (0),
+    m_next (0),
+    m_taken (0),
+    m_total (0),
+    m_state (PanoramaState::Idle),
+    m_started (0),
+    m_estimate (0),
+    m_finished (0),
+    m_slewStarted (0),
+    m_fromPan (0),
+    m_fromTilt (0),
+    m_panArrived (-1),
+    m_tiltArrived (-1),
+    m_captureStarted (0)
+{
+}
+
+std::vector<PanoramaTile> PanoramaEngine::order
+(const std::vector<PanoramaTile>& grid, const std::string& done,
+ TileOrdering ordering) const
+{
+  std::vector<PanoramaTile> todo;
+  for (const PanoramaTile& tile : grid) {
+    if (done[tile.index] == '0') todo.push_back (tile);
+  }
+  return orderTiles (todo, ordering, m_model, m_pan, m_tilt);
+}
+
+std::vector<PanoramaTile> PanoramaEngine::plan
+(const std::vector<PanoramaTile>& grid, const std::string& done,
+ TileOrdering ordering, double& estimate) const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  std::vector<PanoramaTile> tiles;
+  estimate = 0;
+  if (! validTileMask (done, grid.size())) return tiles;
+  tiles = order (grid, done, ordering);
+  estimate = estimateDuration (tiles, m_model, m_pan, m_tilt);
+  return tiles;
+}
+
+bool PanoramaEngine::start (const std::vector<PanoramaTile>& grid,
+                            const std::string& done, TileOrdering ordering)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  if (m_state != PanoramaState::Idle || ! validTileMask (done, grid.size())) {
+    return false;
+  }
+  std::vector<PanoramaTile> tiles = order (grid, done, ordering);
+  if (tiles.empty()) return false;
+  m_tiles = tiles;
+  m_next = 0;
+  m_done = done;
+  m_total = grid.size();
+  m_taken = m_total - m_tiles.size();
+  m_started = m_hooks.now();
+  m_finished = 0;
+  m_estimate = estimateDuration (m_tiles, m_model, m_pan, m_tilt);
+  slew();
+  return true;
+}
+
+void PanoramaEngine::stop ()
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  if (m_state == PanoramaState::Idle) return;
+  m_state = PanoramaState::Idle;
+  m_finished = m_hooks.now();
+  report();
+}
+
+void PanoramaEngine::slew ()
+{
+  const PanoramaTile& tile = m_tiles[m_next];
+  m_state = PanoramaState::Slewing;
+  m_slewStarted = m_hooks.now();
+  m_fromPan = m_pan;
+  m_fromTilt = m_tilt;
+  m_panArrived = m_tiltArrived = -1;
+  report();
+  m_hooks.point (tile.pan, tile.tilt);
+}
+
+void PanoramaEngine::settled ()
+{
+  // Each axis moves at its own rate, and the antenna settles once the later
+  // one arrives.
+  const PanoramaTile& tile = m_tiles[m_next];
+  double now = m_hooks.now();
+  auto learn_rate = [this] (double& rate, double from, double to,
+                            double arrived) {
+    double seconds = arrived - m_slewStarted;
+    if (fabs (to - from) >= MinLearningSlew && seconds > 0) {
+      learn (rate, fabs (to - from) / seconds);
+    }
+  };
+  learn_rate (m_model.panRate, m_fromPan, tile.pan, m_panArrived);
+  learn_rate (m_model.tiltRate, m_fromTilt, tile.tilt, m_tiltArrived);
+  double arrived = std::max (m_panArrived, m_tiltArrived);
+  if (arrived > m_slewStarted) learn (m_model.settleTime, now - arrived);
+  m_captureStarted = now;
+}
+
+void PanoramaEngine::report ()
+{
+  m_hooks.progress (m_state, m_taken, m_total, m_done);
+}
+
+void PanoramaEngine::antennaState (double pan, double tilt,
+                                   double pan_velocity, double tilt_velocity)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  m_pan = pan;
+  m_tilt = tilt;
+  if (m_state != PanoramaState::Slewing) return;
+  const PanoramaTile& tile = m_tiles[m_next];
+  bool pan_there = fabs (pan - tile.pan) <= m_positionTolerance;
+  bool tilt_there = fabs (tilt - tile.tilt) <= m_positionTolerance;
+  if (pan_there && m_panArrived < 0) m_panArrived = m_hooks.now();
+  if (tilt_there && m_tiltArrived < 0) m_tiltArrived = m_hooks.now();
+  if (! pan_there || ! tilt_there ||
+      fabs (pan_velocity) > m_velocityTolerance ||
+      fabs (tilt_velocity) > m_velocityTolerance) {
+    return;
+  }
+  settled();
+  m_state = PanoramaState::Capturing;
+  report();
+  m_hooks.capture();
+}
+
+void PanoramaEngine::pictureTaken ()
+{
+  double estimated, actual;
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    if (m_state != PanoramaState::Capturing) return;
+    double now = m_hooks.now();
+    learn (m_model.captureTime, now - m_captureStarted);
+    m_done[m_tiles[m_next].index] = '1';
+    m_taken++;
+    if (++m_next < m_tiles.size()) {
+      slew();
+      return;
+    }
+    m_state = PanoramaState::Idle;
+    m_finished = now;
+    estimated = m_estimate;
+    actual = m_finished - m_started;
+    report();
+  }
+  // Outside the lock, as finishing may wait on the threads delivering events.
+  m_hooks.finished (estimated, actual);
+}
+
+bool PanoramaEngine::running () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_state != PanoramaState::Idle;
+}
+
+PanoramaState PanoramaEngine::state () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_state;
+}
+
+int PanoramaEngine::tilesTaken () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_taken;
+}
+
+int PanoramaEngine::tileCount () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_total;
+}
+
+std::string PanoramaEngine::tilesDone () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_done;
+}
+
+SlewModel PanoramaEngine::model () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_model;
+}
+
+double PanoramaEngine::estimatedDuration () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_estimate;
+}
+
+double PanoramaEngine::duration () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  if (m_total == 0) return 0;
+  return (m_state == PanoramaState::Idle ? m_finished : m_hooks.now()) -
+    m_started;
+}
@@ -0,0 +1,145 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Panorama_Engine_H
+#define Ow_Panorama_Engine_H
+
+// Panoramic imaging with the antenna-mounted camera.  A panorama is a grid of
+// tiles, each a pan/tilt pointing at which one picture is taken.  The engine
+// steps through the tiles as a state machine driven by antenna telemetry and
+// camera events: point both axes at once, wait for the antenna to settle,
+// capture, and move on as soon as the picture arrives.  The tiles are taken in
+// an order chosen to reduce slewing (see tile_scheduler.h), and the engine
+// learns the antenna's actual slew rates as it goes.  It knows nothing of
+// ROS; the lander interface supplies the hooks that act and the events that
+// drive it.
+
+#include "tile_scheduler.h"
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Camera and antenna geometry, degrees.  Keep in sync with plexil_defs.h.
+const double VerticalFov   = 10; // Easy value for testing.  Should be 15.
+const double HorizontalFov = 10; // Easy value for testing.  Should be 21.
+const double PanMin  = 0;
+const double PanMax  = 359;
+const double TiltMin = -45;
+const double TiltMax = 45;
+
+// Bounds of a panorama and the overlap of adjacent tiles, degrees.
+struct PanoramaSpec
+{
+  double tiltLo, tiltHi;
+  double panLo, panHi;
+  double vertOverlap, horizOverlap;
+};
+
+// False, with the reason, if the panorama can't be taken.
+bool validPanorama (const PanoramaSpec&, std::string& error);
+
+// The tiles of a valid panorama, row by row from tiltLo and panLo, so that
+// a tile's index is its position.  Rows and columns step by half the field of
+// view less the overlap, and the last of each is at the upper bound.
+std::vector<PanoramaTile> panoramaGrid (const PanoramaSpec&);
+
+// Which tiles of a grid have been taken, one character per tile in index
+// order: '1' if taken, '0' if not.  False if the mask is malformed.
+bool validTileMask (const std::string& mask, size_t tiles);
+
+enum class PanoramaState { Idle, Slewing, Capturing };
+
+const char* panoramaStateName (PanoramaState);
+
+class PanoramaEngine
+{
+ public:
+  struct Hooks
+  {
+    // Command the antenna to the given pan and tilt, degrees.
+    std::function<void(double pan, double tilt)> point;
+    // Take a picture; its arrival is reported through pictureTaken().
+    std::function<void()> capture;
+    // Report progress: the state entered, the tiles of the grid taken so
+    // far, and which ones (see validTileMask).
+    std::function<void(PanoramaState, int taken, int total,
+                       const std::string& done)> progress;
+    // Report that every tile has been taken, with the estimated and actual
+    // seconds it took.  Not called after stop().
+    std::function<void(double estimated, double actual)> finished;
+    // The current time, seconds.
+    std::function<double()> now;
+  };
+
+  // The antenna has settled when within position_tolerance (degrees) of its
+  // goal on both axes, moving slower than velocity_tolerance (degrees/s).
+  // The slew model is refined from what the antenna actually does.
+  PanoramaEngine (Hooks hooks, const SlewModel& model,
+                  double position_tolerance, double velocity_tolerance);
+  PanoramaEngine (const PanoramaEngine&) = delete;
+  PanoramaEngine& operator= (const PanoramaEngine&) = delete;
+
+  // Begin a panorama of the given grid, taking the tiles not done (see
+  // validTileMask) in the given order.  False if one is already in progress,
+  // the mask doesn't fit the grid, or every tile is done.
+  bool start (const std::vector<PanoramaTile>& grid, const std::string& done,
+              TileOrdering);
+
+  // The tiles not done, in the order they would be taken from where the
+  // antenna is now, and the estimated seconds to take them.
+  std::vector<PanoramaTile> plan (const std::vector<PanoramaTile>& grid,
+                                  const std::string& done, TileOrdering,
+                                  double& estimate) const;
+
+  // Abandon the panorama in progress, if any.
+  void stop ();
+
+  // Events.  Antenna positions are degrees, velocities degrees/s.
+  void antennaState (double pan, double tilt,
+                     double pan_velocity, double tilt_velocity);
+  void pictureTaken ();
+
+  bool running () const;
+  PanoramaState state () const;
+  int tilesTaken () const;
+  int tileCount () const;
+  std::string tilesDone () const;
+  SlewModel model () const;
+
+  // Of the panorama in progress or the last one, seconds: the estimate made
+  // when it started, and the time taken so far or in all.
+  double estimatedDuration () const;
+  double duration () const;
+
+ private:
+  // Call with the lock held.
+  std::vector<PanoramaTile> order (const std::vector<PanoramaTile>& grid,
+                                   const std::string& done,
+                                   TileOrdering) const;
+  void slew ();      // to the current tile
+  void settled ();   // at the current tile; learn from the slew
+  void report ();    // progress
+
+  const Hooks m_hooks;
+  const double m_positionTolerance;
+  const double m_velocityTolerance;
+  mutable std::mutex m_mutex;
+  SlewModel m_model;
+  double m_pan, m_tilt;          // where the antenna is
+  std::vector<PanoramaTile> m_tiles;  // to take, in order
+  size_t m_next;                 // index in m_tiles of the tile being taken
+  std::string m_done;            // tiles of the grid taken
+  int m_taken, m_total;          // tiles of the grid taken, and in all
+  PanoramaState m_state;
+
+  // Timing of the panorama, and of the slew or capture in progress, seconds.
+  double m_started, m_estimate, m_finished;
+  double m_slewStarted, m_fromPan, m_fromTilt;
+  double m_panArrived, m_tiltArrived;  // negative until the axis is there
+  double m_captureStarted;
+};
+
+#endif
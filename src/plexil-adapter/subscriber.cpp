@@ -39,3 +39,17 @@ void publish (const std::string& state_name, bool val, const std::string& arg)
 {
   SubscriberBoolString (state_name, val, arg);
 }
+
+static BatchHandler BatchBoundary = nullptr;
+
+void setBatchHandler (BatchHandler h) { BatchBoundary = h; }
+
+PublishBatch::PublishBatch ()
+{
+  if (BatchBoundary) BatchBoundary (true);
+}
+
+PublishBatch::~PublishBatch ()
+{
+  if (BatchBoundary) BatchBoundary (false);
+}
@@ -35,4 +35,21 @@ void publish (const string& state_name, double val);
 void publish (const string& state_name, const string& val);
 void publish (const string& state_name, bool val, const string& arg);
 
+// Batching.  While a PublishBatch object is in scope, values published from
+// the same thread are held back and handed to the subscriber all at once when
+// the object goes out of scope, e.g. all the joint values decoded from one ROS
+// message.  Batches may nest; only the outermost one delivers.
+
+typedef void (* BatchHandler) (bool begin);
+void setBatchHandler (BatchHandler);
+
+class PublishBatch
+{
+ public:
+  PublishBatch ();
+  ~PublishBatch ();
+  PublishBatch (const PublishBatch&) = delete;
+  PublishBatch& operator= (const PublishBatch&) = delete;
+};
+
 #endif
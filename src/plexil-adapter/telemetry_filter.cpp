@@ -0,0 +1,119 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "telemetry_filter.h"
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+using std::string;
+
+// C
+#include <cmath>
+
+using Clock = std::chrono::steady_clock;
+
+// Filters as configured, by state name or '*' pattern.
+static std::map<string, TelemetryFilterSpec> FilterSpecs;
+
+// Filter state for each state name seen so far, including those without a
+// filter, so that pattern matching happens only once per state.
+struct FilterState
+{
+  bool active = false;
+  TelemetryFilterSpec spec;
+  bool published = false;   // has any value passed yet?
+  double last = 0;          // last value passed
+  Clock::time_point when;   // time it passed
+};
+
+static std::unordered_map<string, FilterState> FilterStates;
+
+// Telemetry is published from several ROS callback threads.
+static std::mutex FilterMutex;
+
+static bool ends_with (const string& s, const string& suffix)
+{
+  return s.size() >= suffix.size() &&
+    s.compare (s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static FilterState resolve (const string& state_name)
+{
+  FilterState result;
+  auto exact = FilterSpecs.find (state_name);
+  if (exact != FilterSpecs.end()) {
+    result.active = true;
+    result.spec = exact->second;
+    return result;
+  }
+  for (const auto& entry : FilterSpecs) {
+    const string& name = entry.first;
+    if (name[0] == '*' && ends_with (state_name, name.substr (1))) {
+      result.active = true;
+      result.spec = entry.second;
+      break;
+    }
+  }
+  return result;
+}
+
+void setTelemetryFilter (const string& state_name,
+                         const TelemetryFilterSpec& spec,
+                         bool replace)
+{
+  if (state_name.empty()) return;
+  std::lock_guard<std::mutex> lock (FilterMutex);
+  if (replace) FilterSpecs[state_name] = spec;
+  else FilterSpecs.emplace (state_name, spec);
+  FilterStates.clear();  // resolutions may have changed
+}
+
+static bool sign_changed (double last, double value)
+{
+  return std::signbit (last) != std::signbit (value) &&
+    last != 0 && value != 0;
+}
+
+bool passesTelemetryFilter (const string& state_name, double value)
+{
+  std::lock_guard<std::mutex> lock (FilterMutex);
+
+  auto iter = FilterStates.find (state_name);
+  if (iter == FilterStates.end()) {
+    iter = FilterStates.emplace (state_name, resolve (state_name)).first;
+  }
+  FilterState& fs = iter->second;
+  if (! fs.active) return true;
+
+  Clock::time_point now = Clock::now();
+  bool pass;
+
+  if (! fs.published || std::isnan (fs.last) != std::isnan (value)) {
+    pass = true;
+  }
+  else if (fs.spec.publishOnSignChange && sign_changed (fs.last, value)) {
+    pass = true;
+  }
+  else if (fs.spec.maxRate > 0 &&
+           std::chrono::duration<double> (now - fs.when).count() <
+           1.0 / fs.spec.maxRate) {
+    pass = false;
+  }
+  else {
+    double deadband = std::max (fs.spec.absoluteDeadband,
+                                fs.spec.relativeDeadband * fabs (fs.last));
+    pass = fabs (value - fs.last) > deadband;
+  }
+
+  if (pass) {
+    fs.published = true;
+    fs.last = value;
+    fs.when = now;
+  }
+  return pass;
+}
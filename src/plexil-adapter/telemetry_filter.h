@@ -0,0 +1,39 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Telemetry_Filter_H
+#define Ow_Telemetry_Filter_H
+
+// Change filters for numeric telemetry published to PLEXIL.  A filter decides
+// whether a new value of a state differs enough from the last value passed on
+// to be worth propagating to the executive, so that plan conditions are
+// re-evaluated only when something relevant happens.
+//
+// Note that a suppressed value is not sent later: the executive's view of a
+// filtered state may lag the true value by up to the deadband, or, with a rate
+// limit, until the next value that passes.  Lookups are not filtered.
+
+#include <string>
+
+struct TelemetryFilterSpec
+{
+  // Use compiler's default methods.
+  double absoluteDeadband = 0;    // minimum change to pass
+  double relativeDeadband = 0;    // minimum change, as fraction of last value
+  double maxRate = 0;             // Hz; 0 means unlimited
+  bool publishOnSignChange = true; // sign changes bypass deadband and rate
+};
+
+// Install a filter for the given state.  A name beginning with '*' applies to
+// all states whose names end with the rest of it, e.g. "*Effort"; exact names
+// take precedence.  Unless 'replace' is true, an existing filter is kept.
+void setTelemetryFilter (const std::string& state_name,
+                         const TelemetryFilterSpec& spec,
+                         bool replace = true);
+
+// Should this new value of the state be propagated?  Records the value as the
+// last one passed if so.  States without a filter always pass.
+bool passesTelemetryFilter (const std::string& state_name, double value);
+
+#endif
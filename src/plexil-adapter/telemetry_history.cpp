@@ -0,0 +1,121 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "telemetry_history.h"
+
+// C++
+#include <algorithm>
+
+// C
+#include <cmath>
+
+TelemetryHistory::TelemetryHistory (size_t capacity)
+{
+  setCapacity (capacity);
+}
+
+void TelemetryHistory::setCapacity (size_t capacity)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  m_capacity = capacity;
+  m_count = 0;
+  m_times.assign (capacity, 0);
+  m_values.assign (capacity, 0);
+  m_sumBefore.assign (capacity, 0);
+  m_squaresBefore.assign (capacity, 0);
+  m_sum = 0;
+  m_squares = 0;
+}
+
+void TelemetryHistory::add (double time, double value)
+{
+  // A NaN or infinity would spoil the running sums for good.
+  if (! std::isfinite (value) || ! std::isfinite (time)) return;
+
+  std::lock_guard<std::mutex> lock (m_mutex);
+  if (m_capacity == 0) return;
+  if (m_count > 0 && time < m_times[slot (m_count - 1)]) {
+    m_count = 0;
+    m_sum = 0;
+    m_squares = 0;
+  }
+  if (m_count >= m_capacity && slot (m_count) == 0) rebase();
+  size_t i = slot (m_count++);
+  m_times[i] = time;
+  m_values[i] = value;
+  m_sumBefore[i] = m_sum;
+  m_squaresBefore[i] = m_squares;
+  m_sum += value;
+  m_squares += value * value;
+}
+
+void TelemetryHistory::rebase ()
+{
+  // Recompute the running sums from zero over the samples that remain once
+  // the oldest is replaced, so that they stay as small as the values retained
+  // and rounding error can't accumulate over a long run.  Done once per turn
+  // of the ring, so its cost per sample is constant.
+  m_sum = 0;
+  m_squares = 0;
+  for (size_t s = m_count - m_capacity + 1; s < m_count; s++) {
+    size_t i = slot (s);
+    m_sumBefore[i] = m_sum;
+    m_squaresBefore[i] = m_squares;
+    m_sum += m_values[i];
+    m_squares += m_values[i] * m_values[i];
+  }
+}
+
+bool TelemetryHistory::statistic (Statistic stat, double now, double window,
+                                  double& result) const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  size_t retained = std::min (m_count, m_capacity);
+  if (retained == 0) return false;
+
+  // Samples are in time order, so the window's first sample is found by
+  // binary search over the retained ones.
+  size_t oldest = m_count - retained;
+  size_t lo = oldest, hi = m_count;
+  double start = now - window;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (m_times[slot (mid)] > start) hi = mid;
+    else lo = mid + 1;
+  }
+  size_t first = lo;
+  size_t last = m_count;  // one past
+  while (last > first && m_times[slot (last - 1)] > now) last--;
+  if (first == last) return false;
+
+  double n = last - first;
+  auto sum_before = [this] (const std::vector<double>& before, double total,
+                            size_t sample) {
+    return sample == m_count ? total : before[slot (sample)];
+  };
+
+  switch (stat) {
+  case Statistic::Mean:
+    result = (sum_before (m_sumBefore, m_sum, last) -
+              m_sumBefore[slot (first)]) / n;
+    break;
+  case Statistic::RMS:
+    // Clamped, as rounding in the running sums could make it negative.
+    result = sqrt (std::max (0.0, (sum_before (m_squaresBefore, m_squares,
+                                               last) -
+                                   m_squaresBefore[slot (first)]) / n));
+    break;
+  case Statistic::Min:
+  case Statistic::Max: {
+    result = m_values[slot (first)];
+    for (size_t s = first + 1; s < last; s++) {
+      double v = m_values[slot (s)];
+      result = stat == Statistic::Min ? std::min (result, v)
+                                      : std::max (result, v);
+    }
+    break;
+  }
+  }
+  return true;
+}
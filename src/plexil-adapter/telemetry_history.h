@@ -0,0 +1,66 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Telemetry_History_H
+#define Ow_Telemetry_History_H
+
+// Recent history of numeric telemetry, with statistics over a trailing time
+// window, so that plans can ask for trends (e.g. mean effort over the last 5
+// seconds) instead of sampling and computing them in PLEXIL.
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+enum class Statistic { Min, Max, Mean, RMS };
+
+// Quantities of which history is kept.
+enum class JointQuantity { Position, Velocity, Effort };
+enum class PowerQuantity {
+  StateOfCharge,
+  RemainingUsefulLife,
+  BatteryTemperature,
+  Count
+};
+
+// A fixed number of the latest samples of one value, kept in contiguous ring
+// buffers along with running sums, so that a window's mean and RMS cost two
+// subtractions; min and max scan the window.  Windows reaching further back
+// than the retained samples cover only those.  Samples must be added in time
+// order, by one thread at a time; a sample earlier than the last (e.g. after a
+// simulation reset) discards the history, and one that isn't finite is
+// ignored.  Queries are safe from any thread.
+
+class TelemetryHistory
+{
+ public:
+  TelemetryHistory (size_t capacity = 0);
+  TelemetryHistory (const TelemetryHistory&) = delete;
+  TelemetryHistory& operator= (const TelemetryHistory&) = delete;
+
+  // Discards the history.
+  void setCapacity (size_t capacity);
+
+  void add (double time, double value);
+
+  // Compute the statistic over samples with time in (now - window, now].
+  // Returns false if there are none.
+  bool statistic (Statistic, double now, double window, double& result) const;
+
+ private:
+  size_t slot (size_t sample) const { return sample % m_capacity; }
+  void rebase ();  // the running sums; call with the lock held
+
+  mutable std::mutex m_mutex;
+  size_t m_capacity;
+  size_t m_count;                 // samples added since last reset
+  std::vector<double> m_times;
+  std::vector<double> m_values;
+  std::vector<double> m_sumBefore;   // by sample: sum of earlier values
+  std::vector<double> m_squaresBefore; // and of their squares
+  double m_sum;                   // of all values added
+  double m_squares;
+};
+
+#endif
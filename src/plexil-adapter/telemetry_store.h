@@ -0,0 +1,133 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Telemetry_Store_H
+#define Ow_Telemetry_Store_H
+
+// Telemetry shared between the ROS callback threads, which write it, and the
+// PLEXIL executive, which reads it through lookups.  Nothing here takes a
+// lock: multi-word values are guarded by sequence locks, single words are
+// plain atomics.  (Faults are kept in their own tables, see fault_support.h.)
+
+#include "joint_support.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// A sequence lock for a small, trivially copyable value with a single writer.
+// Readers never block the writer; a reader that overlaps a write retries, so
+// it never sees a torn value.  The value is kept in atomic words so that the
+// overlapping accesses are well defined.
+
+template <typename T>
+class SeqLock
+{
+  static_assert (std::is_trivially_copyable<T>::value,
+                 "SeqLock requires a trivially copyable type");
+ public:
+  SeqLock (const T& init = T()) { store (init); }
+  SeqLock (const SeqLock&) = delete;
+  SeqLock& operator= (const SeqLock&) = delete;
+
+  // Only one thread may store at a time.
+  void store (const T& val)
+  {
+    uint64_t words[Words] = { };
+    std::memcpy (words, &val, sizeof (T));
+    uint32_t seq = m_sequence.load (std::memory_order_relaxed);
+    m_sequence.store (seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    for (int i = 0; i < Words; i++) {
+      m_words[i].store (words[i], std::memory_order_relaxed);
+    }
+    m_sequence.store (seq + 2, std::memory_order_release);
+  }
+
+  T load () const
+  {
+    uint64_t words[Words];
+    uint32_t before, after;
+    do {
+      before = m_sequence.load (std::memory_order_acquire);
+      for (int i = 0; i < Words; i++) {
+        words[i] = m_words[i].load (std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence (std::memory_order_acquire);
+      after = m_sequence.load (std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    T val;
+    std::memcpy (&val, words, sizeof (T));
+    return val;
+  }
+
+ private:
+  static const int Words = (sizeof (T) + sizeof (uint64_t) - 1) /
+    sizeof (uint64_t);
+  std::atomic<uint32_t> m_sequence { 0 };
+  std::atomic<uint64_t> m_words[Words];
+};
+
+// Scalar telemetry.
+enum class TelemetryChannel {
+  StateOfCharge,
+  RemainingUsefulLife,
+  BatteryTemperature,
+  PanDegrees,     // antenna pan position, from joint states
+  TiltDegrees,    // antenna tilt position, from joint states
+  Count
+};
+
+// Outcome of the last GuardedMove; the two fields are only meaningful
+// together.
+struct GroundContact
+{
+  bool found = false;
+  double position = 0; // should not be queried unless found
+};
+
+class TelemetryStore
+{
+ public:
+  TelemetryStore ()
+  {
+    for (auto& channel : m_channels) channel.store (NAN);
+  }
+  TelemetryStore (const TelemetryStore&) = delete;
+  TelemetryStore& operator= (const TelemetryStore&) = delete;
+
+  JointTelemetry joint (Joint joint) const
+  {
+    return m_joints[jointIndex (joint)].load();
+  }
+
+  void setJoint (Joint joint, const JointTelemetry& telemetry)
+  {
+    m_joints[jointIndex (joint)].store (telemetry);
+  }
+
+  double get (TelemetryChannel channel) const
+  {
+    return m_channels[index (channel)].load (std::memory_order_acquire);
+  }
+
+  void set (TelemetryChannel channel, double val)
+  {
+    m_channels[index (channel)].store (val, std::memory_order_release);
+  }
+
+  GroundContact ground () const { return m_ground.load(); }
+  void setGround (const GroundContact& ground) { m_ground.store (ground); }
+
+ private:
+  static int index (TelemetryChannel c) { return static_cast<int>(c); }
+
+  SeqLock<JointTelemetry> m_joints[NumJoints];
+  std::atomic<double> m_channels[static_cast<int>(TelemetryChannel::Count)];
+  SeqLock<GroundContact> m_ground;
+};
+
+#endif
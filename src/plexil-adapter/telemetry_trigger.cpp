@@ -0,0 +1,185 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "telemetry_trigger.h"
+
+// C++
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+using std::string;
+
+struct Trigger
+{
+  string name;
+  Comparator comparator;
+  double threshold;
+  double persistence;
+  bool active = false;
+  bool pending = false;   // comparison disagrees with 'active'...
+  double since = 0;       // ...since this time
+};
+
+// Triggers by the state they watch, and the state watched by each trigger.
+static std::unordered_map<string, std::vector<Trigger>> TriggersByState;
+static std::unordered_map<string, string> TriggerStates;
+static std::atomic<int> TriggerCount { 0 };
+static std::mutex TriggerMutex;
+
+// Flips are delivered outside TriggerMutex, so two threads evaluating the same
+// trigger could deliver its flips out of order.  Each flip is numbered as it
+// happens (under TriggerMutex), and delivery drops any flip older than the
+// last one delivered for its trigger name, so that the last delivered is the
+// trigger's current state.
+struct Flip
+{
+  string name;
+  bool active;
+  unsigned long sequence;
+};
+static unsigned long FlipSequence = 0;  // guarded by TriggerMutex
+static std::unordered_map<string, unsigned long> LastDelivered;
+static std::mutex DeliveryMutex;
+
+static void deliver (const std::vector<Flip>& flips,
+                     const TriggerFlipHandler& on_flip)
+{
+  std::lock_guard<std::mutex> lock (DeliveryMutex);
+  for (const auto& flip : flips) {
+    unsigned long& last = LastDelivered[flip.name];
+    if (flip.sequence <= last) continue;
+    last = flip.sequence;
+    on_flip (flip.name, flip.active);
+  }
+}
+
+bool parseComparator (const string& text, Comparator& comparator)
+{
+  static const std::unordered_map<string, Comparator> comparators {
+    { "<", Comparator::Less },
+    { "<=", Comparator::LessEqual },
+    { ">", Comparator::Greater },
+    { ">=", Comparator::GreaterEqual },
+    { "==", Comparator::Equal },
+    { "!=", Comparator::NotEqual }
+  };
+  auto entry = comparators.find (text);
+  if (entry == comparators.end()) return false;
+  comparator = entry->second;
+  return true;
+}
+
+static bool compare (Comparator comparator, double value, double threshold)
+{
+  // A value that isn't a number is no evidence that all is well.
+  if (! std::isfinite (value)) return true;
+  switch (comparator) {
+  case Comparator::Less:         return value < threshold;
+  case Comparator::LessEqual:    return value <= threshold;
+  case Comparator::Greater:      return value > threshold;
+  case Comparator::GreaterEqual: return value >= threshold;
+  case Comparator::Equal:        return value == threshold;
+  case Comparator::NotEqual:     return value != threshold;
+  }
+  return false;
+}
+
+// Caller holds TriggerMutex.  A trigger removed while active flips to false.
+static bool remove_trigger (const string& name, std::vector<Flip>& flipped)
+{
+  auto state = TriggerStates.find (name);
+  if (state == TriggerStates.end()) return false;
+  auto& triggers = TriggersByState[state->second];
+  for (auto t = triggers.begin(); t != triggers.end(); ++t) {
+    if (t->name == name) {
+      if (t->active) flipped.push_back ({ name, false, ++FlipSequence });
+      triggers.erase (t);
+      break;
+    }
+  }
+  if (triggers.empty()) TriggersByState.erase (state->second);
+  TriggerStates.erase (state);
+  --TriggerCount;
+  return true;
+}
+
+void addTrigger (const string& name, const string& state_name,
+                 Comparator comparator, double threshold, double persistence,
+                 const TriggerFlipHandler& on_flip)
+{
+  std::vector<Flip> flipped;
+  {
+    std::lock_guard<std::mutex> lock (TriggerMutex);
+    remove_trigger (name, flipped);
+    Trigger trigger;
+    trigger.name = name;
+    trigger.comparator = comparator;
+    trigger.threshold = threshold;
+    trigger.persistence = persistence;
+    TriggersByState[state_name].push_back (trigger);
+    TriggerStates[name] = state_name;
+    ++TriggerCount;
+  }
+  deliver (flipped, on_flip);
+}
+
+bool removeTrigger (const string& name, const TriggerFlipHandler& on_flip)
+{
+  std::vector<Flip> flipped;
+  bool removed;
+  {
+    std::lock_guard<std::mutex> lock (TriggerMutex);
+    removed = remove_trigger (name, flipped);
+  }
+  deliver (flipped, on_flip);
+  return removed;
+}
+
+bool triggerActive (const string& name)
+{
+  std::lock_guard<std::mutex> lock (TriggerMutex);
+  auto state = TriggerStates.find (name);
+  if (state == TriggerStates.end()) return false;
+  for (const auto& trigger : TriggersByState[state->second]) {
+    if (trigger.name == name) return trigger.active;
+  }
+  return false;
+}
+
+bool anyTriggers ()
+{
+  return TriggerCount.load (std::memory_order_relaxed) > 0;
+}
+
+void evaluateTriggers (const string& state_name, double value, double time,
+                       const TriggerFlipHandler& on_flip)
+{
+  // Flips are reported after the lock is released, so that the handler may
+  // use the functions above.
+  std::vector<Flip> flipped;
+  {
+    std::lock_guard<std::mutex> lock (TriggerMutex);
+    auto entry = TriggersByState.find (state_name);
+    if (entry == TriggersByState.end()) return;
+    for (auto& trigger : entry->second) {
+      bool holds = compare (trigger.comparator, value, trigger.threshold);
+      if (holds == trigger.active) {
+        trigger.pending = false;
+        continue;
+      }
+      if (! trigger.pending) {
+        trigger.pending = true;
+        trigger.since = time;
+      }
+      if (time - trigger.since >= trigger.persistence) {
+        trigger.active = holds;
+        trigger.pending = false;
+        flipped.push_back ({ trigger.name, holds, ++FlipSequence });
+      }
+    }
+  }
+  deliver (flipped, on_flip);
+}
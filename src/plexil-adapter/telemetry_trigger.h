@@ -0,0 +1,62 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Telemetry_Trigger_H
+#define Ow_Telemetry_Trigger_H
+
+// Threshold triggers registered by plans.  A trigger compares each new value
+// of a numeric state against a threshold as it arrives from ROS, and changes
+// state only when the comparison has held (or failed) for its persistence
+// time, so that the executive hears about it once, when it flips, instead of
+// plans polling the state.  Triggers are seen in PLEXIL as
+// Lookup(Trigger(name)).
+//
+// Triggers are evaluated on every value received, before telemetry filtering
+// (see telemetry_filter.h), so a filter does not delay them.  Persistence is
+// measured between received values: a trigger can only flip when a value
+// arrives.
+//
+// A non-finite value (NaN or infinite) satisfies every comparison, so that a
+// trigger watching for trouble fires on telemetry gone bad rather than
+// staying quiet.
+
+#include <functional>
+#include <string>
+
+enum class Comparator { Less, LessEqual, Greater, GreaterEqual, Equal,
+                        NotEqual };
+
+// Parse "<", "<=", ">", ">=", "==", or "!=".  False for anything else.
+bool parseComparator (const std::string& text, Comparator& comparator);
+
+
+// Current state of a trigger; false if there is no such trigger.
+bool triggerActive (const std::string& name);
+
+// Is any trigger registered?  Cheap; lets callers skip evaluation.
+bool anyTriggers ();
+
+// Called with (trigger_name, active) for each trigger that changes.  Calls are
+// serialized, and a flip superseded by a later one of the same trigger (from
+// another thread) is dropped, so the last call for a trigger gives its state.
+using TriggerFlipHandler = std::function<void (const std::string&, bool)>;
+
+// Add a trigger, replacing any of the same name.  It starts out false; a
+// replaced trigger that was active flips to false.  Persistence is in
+// seconds; 0 flips the trigger on the first value that satisfies (or fails)
+// the comparison.
+void addTrigger (const std::string& name, const std::string& state_name,
+                 Comparator comparator, double threshold, double persistence,
+                 const TriggerFlipHandler& on_flip);
+
+// Returns false if there was no such trigger.  A trigger removed while active
+// flips to false.
+bool removeTrigger (const std::string& name, const TriggerFlipHandler& on_flip);
+
+// Evaluate the triggers on this state against its new value, received at the
+// given time, calling on_flip for each that changed.
+void evaluateTriggers (const std::string& state_name, double value,
+                       double time, const TriggerFlipHandler& on_flip);
+
+#endif
@@ -0,0 +1,153 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "tile_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+double SlewModel::slewTime (double from_pan, double from_tilt,
+                            double to_pan, double to_tilt) const
+{
+  double pan_time = panRate > 0 ? fabs (to_pan - from_pan) / panRate : 0;
+  double tilt_time = tiltRate > 0 ? fabs (to_tilt - from_tilt) / tiltRate : 0;
+  return std::max (pan_time, tilt_time) + settleTime;
+}
+
+const char* tileOrderingName (TileOrdering ordering)
+{
+  switch (ordering) {
+    case TileOrdering::Serpentine:  return "Serpentine";
+    case TileOrdering::RowMajor:    return "RowMajor";
+    case TileOrdering::MinimumSlew: return "MinimumSlew";
+  }
+  return "Unknown";
+}
+
+bool parseTileOrdering (const std::string& name, TileOrdering& ordering)
+{
+  for (TileOrdering candidate : { TileOrdering::Serpentine,
+                                  TileOrdering::RowMajor,
+                                  TileOrdering::MinimumSlew }) {
+    if (name == tileOrderingName (candidate)) {
+      ordering = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Passes of segment reversal after the first ordering.  Each pass is quadratic in
+// the tiles; a few passes get nearly all of the improvement.
+static const int ImprovementPasses = 8;
+
+static void order_serpentine (std::vector<PanoramaTile>& tiles)
+{
+  std::sort (tiles.begin(), tiles.end(),
+             [] (const PanoramaTile& a, const PanoramaTile& b) {
+               if (a.row != b.row) return a.row < b.row;
+               return a.row % 2 ? a.column > b.column : a.column < b.column;
+             });
+}
+
+static void order_nearest (std::vector<PanoramaTile>& tiles,
+                           const SlewModel& model, double pan, double tilt)
+{
+  for (size_t i = 0; i < tiles.size(); i++) {
+    size_t nearest = i;
+    double nearest_time = INFINITY;
+    for (size_t j = i; j < tiles.size(); j++) {
+      double t = model.slewTime (pan, tilt, tiles[j].pan, tiles[j].tilt);
+      if (t < nearest_time) {
+        nearest = j;
+        nearest_time = t;
+      }
+    }
+    std::swap (tiles[i], tiles[nearest]);
+    pan = tiles[i].pan;
+    tilt = tiles[i].tilt;
+  }
+}
+
+// Reverse any run of tiles that shortens the path (2-opt).  Slewing either way
+// between two tiles takes the same time, so only the slews into and out of the
+// run change.  The start is fixed and the end is open.
+static void improve (std::vector<PanoramaTile>& tiles, const SlewModel& model,
+                     double pan, double tilt)
+{
+  // Positions are 1-based here so that 0 is the antenna's starting point.
+  auto slew = [&] (size_t from, size_t to) {
+    return from == 0
+      ? model.slewTime (pan, tilt, tiles[to - 1].pan, tiles[to - 1].tilt)
+      : model.slewTime (tiles[from - 1].pan, tiles[from - 1].tilt,
+                        tiles[to - 1].pan, tiles[to - 1].tilt);
+  };
+  size_t n = tiles.size();
+  for (int pass = 0; pass < ImprovementPasses; pass++) {
+    bool improved = false;
+    for (size_t i = 1; i < n; i++) {
+      for (size_t j = i + 1; j <= n; j++) {
+        double before = slew (i - 1, i) + (j < n ? slew (j, j + 1) : 0);
+        double after = slew (i - 1, j) + (j < n ? slew (i, j + 1) : 0);
+        if (after < before - 1e-9) {
+          std::reverse (tiles.begin() + i - 1, tiles.begin() + j);
+          improved = true;
+        }
+      }
+    }
+    if (! improved) break;
+  }
+}
+
+// Improves both the nearest-neighbor tour from where the antenna is and the
+// serpentine, which is hard to beat on a full grid, and takes the faster.
+static void order_minimum_slew (std::vector<PanoramaTile>& tiles,
+                                const SlewModel& model,
+                                double pan, double tilt)
+{
+  std::vector<PanoramaTile> serpentine = tiles;
+  order_serpentine (serpentine);
+  improve (serpentine, model, pan, tilt);
+  order_nearest (tiles, model, pan, tilt);
+  improve (tiles, model, pan, tilt);
+  if (estimateDuration (serpentine, model, pan, tilt) <
+      estimateDuration (tiles, model, pan, tilt)) {
+    tiles.swap (serpentine);
+  }
+}
+
+std::vector<PanoramaTile> orderTiles (std::vector<PanoramaTile> tiles,
+                                      TileOrdering ordering,
+                                      const SlewModel& model,
+                                      double pan, double tilt)
+{
+  switch (ordering) {
+    case TileOrdering::Serpentine:
+      order_serpentine (tiles);
+      break;
+    case TileOrdering::RowMajor:
+      std::sort (tiles.begin(), tiles.end(),
+                 [] (const PanoramaTile& a, const PanoramaTile& b) {
+                   return a.index < b.index;
+                 });
+      break;
+    case TileOrdering::MinimumSlew:
+      order_minimum_slew (tiles, model, pan, tilt);
+      break;
+  }
+  return tiles;
+}
+
+double estimateDuration (const std::vector<PanoramaTile>& tiles,
+                         const SlewModel& model, double pan, double tilt)
+{
+  double seconds = 0;
+  for (const PanoramaTile& tile : tiles) {
+    seconds += model.slewTime (pan, tilt, tile.pan, tile.tilt) +
+      model.captureTime;
+    pan = tile.pan;
+    tilt = tile.tilt;
+  }
+  return seconds;
+}
@@ -0,0 +1,59 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Tile_Scheduler_H
+#define Ow_Tile_Scheduler_H
+
+// Ordering of panorama tiles to reduce antenna slewing, and estimates of the
+// time a panorama takes.  See panorama_engine.h.
+
+#include <string>
+#include <vector>
+
+struct PanoramaTile
+{
+  int index;          // in the grid, row by row
+  int row, column;    // in the grid, from (tiltLo, panLo)
+  double tilt, pan;   // degrees
+};
+
+// How the antenna moves between tiles.  Pan and tilt are driven by separate
+// controllers and move at the same time, so a slew takes as long as the
+// slower axis, and then the antenna must settle.
+struct SlewModel
+{
+  double panRate;      // degrees/s
+  double tiltRate;     // degrees/s
+  double settleTime;   // seconds from arrival until an image can be taken
+  double captureTime;  // seconds from camera trigger to image
+
+  double slewTime (double from_pan, double from_tilt,
+                   double to_pan, double to_tilt) const;
+};
+
+enum class TileOrdering
+{
+  Serpentine,  // row by row, alternating direction
+  RowMajor,    // row by row, always in the same direction
+  MinimumSlew  // shortest total slew time found, starting where the antenna is
+};
+
+// Names are those of the enumerators.  Parsing returns false for an unknown
+// name.
+const char* tileOrderingName (TileOrdering);
+bool parseTileOrdering (const std::string& name, TileOrdering&);
+
+// The tiles, in the order to take them with the antenna starting at the
+// given position.  Any subset of a grid may be ordered, e.g. the tiles not yet
+// taken of an interrupted panorama.
+std::vector<PanoramaTile> orderTiles (std::vector<PanoramaTile> tiles,
+                                      TileOrdering, const SlewModel&,
+                                      double pan, double tilt);
+
+// Seconds to take the tiles in the given order, starting at the given
+// position.
+double estimateDuration (const std::vector<PanoramaTile>& tiles,
+                         const SlewModel&, double pan, double tilt);
+
+#endif
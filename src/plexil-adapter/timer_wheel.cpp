@@ -0,0 +1,99 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <cmath>
+
+TimerWheel::TimerWheel (double tick, int slots)
+  : m_tick (tick),
+    m_slots (std::max (slots, 1)),
+    m_nextId (1),
+    m_currentTick (0),
+    m_started (false)
+{
+}
+
+int64_t TimerWheel::tickOf (double time) const
+{
+  return static_cast<int64_t>(std::floor (time / m_tick));
+}
+
+int TimerWheel::slotOf (int64_t tick) const
+{
+  int64_t slots = m_slots.size();
+  return static_cast<int>(((tick % slots) + slots) % slots);
+}
+
+TimerWheel::TimerId TimerWheel::schedule (double deadline, Callback callback)
+{
+  // A timer goes in the slot of the first tick at or after its deadline, so
+  // that it has expired whenever that slot is processed on the right turn.
+  int64_t tick = static_cast<int64_t>(std::ceil (deadline / m_tick));
+  std::lock_guard<std::mutex> lock (m_mutex);
+  if (m_started && tick <= m_currentTick) tick = m_currentTick + 1;
+  int slot = slotOf (tick);
+  TimerId id = m_nextId++;
+  m_slots[slot].push_back ({ id, deadline, std::move (callback) });
+  m_slotById[id] = slot;
+  return id;
+}
+
+bool TimerWheel::cancel (TimerId id)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  auto entry = m_slotById.find (id);
+  if (entry == m_slotById.end()) return false;
+  std::vector<Timer>& slot = m_slots[entry->second];
+  m_slotById.erase (entry);
+  for (auto timer = slot.begin(); timer != slot.end(); ++timer) {
+    if (timer->id == id) {
+      slot.erase (timer);
+      break;
+    }
+  }
+  return true;
+}
+
+void TimerWheel::expire (std::vector<Timer>& slot, double now,
+                         std::vector<Callback>& expired)
+{
+  auto pending = slot.begin();
+  for (auto& timer : slot) {
+    if (timer.deadline <= now) {
+      m_slotById.erase (timer.id);
+      expired.push_back (std::move (timer.callback));
+    }
+    else *pending++ = std::move (timer);
+  }
+  slot.erase (pending, slot.end());
+}
+
+void TimerWheel::advance (double now)
+{
+  std::vector<Callback> expired;
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    int64_t tick = tickOf (now);
+    if (! m_started || tick - m_currentTick >= (int64_t) m_slots.size()) {
+      // First advance, or a jump of a full turn or more: look everywhere.
+      for (auto& slot : m_slots) expire (slot, now, expired);
+    }
+    else {
+      for (int64_t t = m_currentTick + 1; t <= tick; t++) {
+        expire (m_slots[slotOf (t)], now, expired);
+      }
+    }
+    m_started = true;
+    m_currentTick = tick;
+  }
+  for (auto& callback : expired) callback();
+}
+
+int TimerWheel::pending () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_slotById.size();
+}
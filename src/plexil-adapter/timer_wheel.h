@@ -0,0 +1,70 @@
+// The Notices and Disclaimers for Ocean Worlds Autonomy Testbed for Exploration
+// Research and Simulation can be found in README.md in the root directory of
+// this repository.
+
+#ifndef Ow_Timer_Wheel_H
+#define Ow_Timer_Wheel_H
+
+// A hashed timer wheel: many one-shot deadlines served by a single periodic
+// tick, rather than a thread or ROS timer apiece.  Deadlines fall into slots
+// by tick; a deadline more than one turn of the wheel away waits in its slot
+// for later turns.  Time is whatever clock the caller advances the wheel by,
+// in seconds, and deadlines are honored to within one tick.
+//
+// Timers may be scheduled and cancelled from any thread.  Expired callbacks
+// run in the thread calling advance(), outside the wheel's lock, so they may
+// schedule and cancel timers themselves.
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class TimerWheel
+{
+ public:
+  using Callback = std::function<void()>;
+  using TimerId = uint64_t;
+
+  TimerWheel (double tick, int slots);
+  TimerWheel (const TimerWheel&) = delete;
+  TimerWheel& operator= (const TimerWheel&) = delete;
+
+  // Run the callback once the wheel is advanced to the deadline or beyond.
+  TimerId schedule (double deadline, Callback callback);
+
+  // Returns false if the timer has already expired or been cancelled.
+  bool cancel (TimerId id);
+
+  // Expire every timer whose deadline is at or before now.  If time goes
+  // backwards (e.g. the simulation restarted), pending timers wait for the
+  // clock to reach them again.
+  void advance (double now);
+
+  double tick () const { return m_tick; }
+  int pending () const;
+
+ private:
+  struct Timer
+  {
+    TimerId id;
+    double deadline;
+    Callback callback;
+  };
+
+  int64_t tickOf (double time) const;
+  int slotOf (int64_t tick) const;
+  void expire (std::vector<Timer>& slot, double now,
+               std::vector<Callback>& expired);
+
+  const double m_tick;
+  std::vector<std::vector<Timer>> m_slots;
+  std::unordered_map<TimerId, int> m_slotById;
+  mutable std::mutex m_mutex;
+  TimerId m_nextId;
+  int64_t m_currentTick; // last tick processed
+  bool m_started;        // advanced at least once
+};
+
+#endif